@@ -0,0 +1,146 @@
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+#include "AsmChunkParser.h"
+#include <QAtomicInt>
+#include <QMutex>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QWaitCondition>
+using namespace Asm;
+using namespace Lisa;
+
+// shared by the parser and its helper tasks, which may only start after the parser is done
+class ChunkParser::Work
+{
+public:
+    FileSystem* d_fs;
+    QList<Chunk*> d_chunks;
+    QAtomicInt d_next; // the chunk to be taken next
+    QMutex d_lock;
+    QWaitCondition d_allDone;
+    int d_done;
+
+    Work(FileSystem* fs):d_fs(fs),d_next(0),d_done(0){}
+    ~Work()
+    {
+        for( int i = 0; i < d_chunks.size(); i++ )
+            delete d_chunks[i];
+    }
+    bool parseNext()
+    {
+        const int i = d_next.fetchAndAddOrdered(1);
+        if( i >= d_chunks.size() )
+            return false;
+        Chunk* c = d_chunks[i];
+        PpLexer lex(d_fs);
+        lex.reset(c->d_toks);
+        Parser p(&lex);
+        p.RunParser();
+        c->d_root.d_children = p.d_root.d_children;
+        p.d_root.d_children.clear();
+        c->d_errors = p.errors;
+        QMutexLocker lock(&d_lock);
+        if( ++d_done == d_chunks.size() )
+            d_allDone.wakeAll();
+        return true;
+    }
+    void waitForDone()
+    {
+        QMutexLocker lock(&d_lock);
+        while( d_done < d_chunks.size() )
+            d_allDone.wait(&d_lock);
+    }
+};
+
+class ChunkParser::Task : public QRunnable
+{
+public:
+    Task(const QSharedPointer<Work>& w):d_work(w){}
+    void run()
+    {
+        while( d_work->parseNext() )
+            ;
+    }
+private:
+    QSharedPointer<Work> d_work;
+};
+
+ChunkParser::ChunkParser(FileSystem* fs, QThreadPool* pool):d_fs(fs),d_pool(pool)
+{
+    if( d_pool == 0 )
+        d_pool = QThreadPool::globalInstance();
+}
+
+ChunkParser::~ChunkParser()
+{
+}
+
+void ChunkParser::RunParser(const QString& filePath)
+{
+    d_lex.reset(new PpLexer(d_fs));
+    d_lex->reset(filePath);
+
+    // a chunk ends with the eol of the line which reaches the minimum size
+    QSharedPointer<Work> work(new Work(d_fs));
+    QList<Chunk*>& chunks = work->d_chunks;
+    chunks.append(new Chunk());
+    Token t = d_lex->nextToken();
+    while( t.d_type != Tok_Eof )
+    {
+        chunks.back()->d_toks.append(t);
+        if( t.d_type == Tok_eol && chunks.back()->d_toks.size() >= MinChunk )
+            chunks.append(new Chunk());
+        t = d_lex->nextToken();
+    }
+
+    const int helpers = qMin(chunks.size(), d_pool->maxThreadCount()) - 1;
+    for( int i = 0; i < helpers; i++ )
+        d_pool->start(new Task(work));
+    while( work->parseNext() )
+        ;
+    work->waitForDone();
+
+    bool ok = true;
+    foreach( Chunk* c, chunks )
+    {
+        if( !c->d_errors.isEmpty() )
+            ok = false;
+    }
+    if( ok )
+    {
+        foreach( Chunk* c, chunks )
+        {
+            d_root.d_children += c->d_root.d_children;
+            c->d_root.d_children.clear();
+        }
+    }else
+        runSequential(filePath); // the sequential parser might also stop early and read less of the file
+}
+
+void ChunkParser::runSequential(const QString& filePath)
+{
+    // a fresh lexer, since the macros of the first run would already be known from the start
+    d_lex.reset(new PpLexer(d_fs));
+    d_lex->reset(filePath);
+    Parser p(d_lex.data());
+    p.RunParser();
+    d_root.d_tok = p.d_root.d_tok;
+    d_root.d_children = p.d_root.d_children;
+    p.d_root.d_children.clear();
+    errors = p.errors;
+}
@@ -0,0 +1,65 @@
+#ifndef ASMCHUNKPARSER_H
+#define ASMCHUNKPARSER_H
+
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+#include "AsmParser.h"
+#include "AsmPpLexer.h"
+#include <QScopedPointer>
+
+class QThreadPool;
+
+namespace Asm
+{
+// Parses a file like Parser::RunParser, but in chunks of lines in parallel. Includes and macros
+// depend on the preceding lines, so the file is lexed first; the grammar is line based, so the
+// chunks can then be parsed independently and joined. If a chunk has errors, the recovery might
+// depend on the preceding chunk, so the file is parsed again sequentially; the result is always
+// the same as the one of Parser.
+// The chunks are parsed by the calling thread and by helpers started on the given pool (the global
+// one by default), which may be the pool the caller runs on; a helper which only gets a thread
+// when the calling thread has already taken all chunks just ends, so nobody waits on queued tasks.
+class ChunkParser
+{
+public:
+    enum { MinChunk = 2000 }; // tokens
+    ChunkParser(Lisa::FileSystem*, QThreadPool* = 0);
+    ~ChunkParser();
+    void RunParser(const QString& filePath);
+    // only valid after RunParser
+    const QList<PpLexer::Include>& getIncludes() const { return d_lex->getIncludes(); }
+    quint32 getSloc() const { return d_lex->getSloc(); }
+
+    SynTree d_root;
+    QList<Parser::Error> errors;
+private:
+    struct Chunk
+    {
+        QList<Token> d_toks;
+        SynTree d_root;
+        QList<Parser::Error> d_errors;
+    };
+    class Work;
+    class Task;
+    void runSequential(const QString& filePath);
+    Lisa::FileSystem* d_fs;
+    QThreadPool* d_pool;
+    QScopedPointer<PpLexer> d_lex;
+};
+}
+
+#endif // ASMCHUNKPARSER_H
@@ -17,8 +17,68 @@
 #include "AsmLexer.h"
 #include <QtDebug>
 #include <QBuffer>
+#include <string.h>
 using namespace Asm;
 
+namespace
+{
+// case insensitive perfect hash of the mnemonics and directives (see asm/LisaAsm.keywords); the seed
+// is searched once so that each keyword has a slot of its own and a lookup costs one hash and compare
+class Keywords
+{
+public:
+    Keywords():d_seed(0),d_minLen(0xff),d_maxLen(0)
+    {
+        while( !fill() )
+            d_seed++;
+    }
+    TokenType find(const char* str, int len) const
+    {
+        if( len < d_minLen || len > d_maxLen )
+            return Tok_Invalid;
+        const quint8 t = d_slots[hash(str, len, d_seed) & ( Size - 1 )];
+        if( t == Tok_Invalid )
+            return Tok_Invalid;
+        const char* kw = tokenTypeString(t); // upper case
+        for( int i = 0; i < len; i++ )
+        {
+            if( ::toupper(quint8(str[i])) != kw[i] )
+                return Tok_Invalid;
+        }
+        return kw[len] == 0 ? TokenType(t) : Tok_Invalid;
+    }
+private:
+    enum { Size = 2048 };
+    static quint32 hash(const char* str, int len, quint32 seed)
+    {
+        quint32 h = 2166136261u ^ seed;
+        for( int i = 0; i < len; i++ )
+            h = ( h ^ quint8(str[i] & ~0x20) ) * 16777619u; // ignores case of letters
+        return h;
+    }
+    bool fill()
+    {
+        ::memset(d_slots, Tok_Invalid, sizeof(d_slots));
+        for( int t = TT_Keywords + 1; t < TT_Specials; t++ )
+        {
+            const char* kw = tokenTypeString(t);
+            const int len = ::strlen(kw);
+            d_minLen = qMin(d_minLen, len);
+            d_maxLen = qMax(d_maxLen, len);
+            quint8& slot = d_slots[hash(kw, len, d_seed) & ( Size - 1 )];
+            if( slot != Tok_Invalid )
+                return false;
+            slot = t;
+        }
+        return true;
+    }
+    quint32 d_seed;
+    int d_minLen, d_maxLen;
+    quint8 d_slots[Size]; // TokenType
+};
+}
+static const Keywords s_keywords;
+
 Lexer::Lexer():
     d_lastToken(Tok_Invalid),d_lineNr(0),d_colNr(0),d_in(0),
     d_ignoreComments(true), d_packComments(true),d_sloc(0),d_lineCounted(false),
@@ -205,8 +265,11 @@ Token Lexer::token(TokenType tt, int len, const QByteArray& val, bool dotPrefix)
     if( tt != Tok_Invalid && tt != Tok_Comment && tt != Tok_Eof )
         countLine();
     Token t( tt, d_lineNr, d_colNr + 1, val );
+    if( tt == Tok_ident || tt == Tok_label || tt == Tok_macrocall )
+        t.d_id = Token::toId(val.constData(), val.size());
     d_lastToken = t;
     d_colNr += len;
+    t.d_len = len;
     t.d_sourcePath = d_filePath;
     t.d_dotPrefix = dotPrefix;
     return t;
@@ -225,11 +288,14 @@ Token Lexer::ident(bool dotPrefix)
         else
             off++;
     }
-    QByteArray str = d_line.mid(d_colNr, off );
+    // keywords and macros are looked up in the line; only the value of the token is allocated
+    const char* str = d_line.constData() + d_colNr;
+    int len = off;
     if( dotPrefix )
     {
-        str = str.mid(1);
-        if( str.size() == 1 )
+        str++;
+        len--;
+        if( len == 1 )
         {
             const char ch = str[0];
             if( ch == 'W' || ch == 'w' )
@@ -241,31 +307,27 @@ Token Lexer::ident(bool dotPrefix)
             else if( ch == 'S' || ch == 's' )
                 return token( Tok_dotS, 2, d_line.mid(d_colNr,2), true );
         }
-    }else if( str.size() >= 2 && str[str.size()-2] == '.' )
+    }else if( len >= 2 && str[len-2] == '.' )
     {
-        const char suffix = str[str.size()-1];
+        const char suffix = str[len-1];
         if( suffix == 'W' || suffix == 'w' || suffix == 'L' || suffix == 'l'
                 || suffix == 'B' || suffix == 'b' || suffix == 'S' || suffix == 's' )
         {
             off -= 2;
-            str.chop(2);
+            len -= 2;
         }
     }
-    if( dotPrefix && str.isEmpty() )
+    if( dotPrefix && len == 0 )
         return token( Tok_Invalid, 1, "unexpected character '.'" );
 
-    Q_ASSERT( !str.isEmpty() );
-    int pos = 0;
-    const QByteArray keyword = str.toUpper();
-    TokenType t = tokenTypeFromString( keyword, &pos );
-    if( t != Tok_Invalid && pos != str.size() )
-        t = Tok_Invalid;
+    Q_ASSERT( len > 0 );
+    const TokenType t = s_keywords.find( str, len );
     if( t != Tok_Invalid )
     {
         const bool isDirective = Token::isDirective(t);
         if( !isDirective || ( dotPrefix && isDirective ) || ( !dotPrefix && t == Tok_EQU ) )
         {
-            Token res = token( t, off, str, dotPrefix );
+            Token res = token( t, off, QByteArray(str,len), dotPrefix );
             if( d_macros && isDirective && t == Tok_MACRO )
             {
                 Token name = readMacro();
@@ -281,9 +343,9 @@ Token Lexer::ident(bool dotPrefix)
         }
     }
     // else
-    if( findMacro( str ) )
+    if( findMacro( str, len ) )
     {
-        Token id = token( Asm::Tok_macrocall, off, str );
+        Token id = token( Asm::Tok_macrocall, off, QByteArray(str,len) );
         d_colNr = d_line.size(); // just eat arguments
         Token eol;
         eol.d_type = Tok_eol;
@@ -293,7 +355,7 @@ Token Lexer::ident(bool dotPrefix)
         d_buffer.append(eol);
         return id;
     }else
-        return token( Tok_ident, off, str );
+        return token( Tok_ident, off, QByteArray(str,len) );
 }
 
 static inline bool isHexDigit( char c )
@@ -482,11 +544,23 @@ Token Lexer::readMacro()
     return name;
 }
 
-bool Lexer::findMacro(const QByteArray& name) const
+bool Lexer::findMacro(const char* name, int len) const
 {
-    if( d_macros == 0 )
+    if( d_macros == 0 || d_macros->isEmpty() )
         return false;
 
-    QByteArray lc = name.toLower();
-    return d_macros->contains(lc);
+    char buf[64];
+    bool ascii = len <= int(sizeof(buf));
+    for( int i = 0; i < len && ascii; i++ )
+    {
+        const char ch = name[i];
+        if( ch & 0x80 )
+            ascii = false;
+        else
+            buf[i] = ch >= 'A' && ch <= 'Z' ? ch + ( 'a' - 'A' ) : ch;
+    }
+    if( ascii )
+        return d_macros->contains(QByteArray::fromRawData(buf,len));
+    else
+        return d_macros->contains(QByteArray(name,len).toLower());
 }
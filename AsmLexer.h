@@ -69,7 +69,7 @@ protected:
     Token label();
     void countLine();
     Token readMacro();
-    bool findMacro(const QByteArray&) const;
+    bool findMacro(const char*, int len) const;
 private:
     QIODevice* d_in;
     QString d_filePath;
@@ -21,7 +21,7 @@
 using namespace Asm;
 using namespace Lisa;
 
-PpLexer::PpLexer(FileSystem* fs):d_fs(fs),d_sloc(0)
+PpLexer::PpLexer(FileSystem* fs):d_fs(fs),d_sloc(0),d_replayPos(0)
 {
     Q_ASSERT(fs);
 }
@@ -41,15 +41,16 @@ bool PpLexer::reset(const QString& filePath)
     d_files.clear();
     d_sloc = 0;
     d_includes.clear();
+    d_replay.clear();
+    d_replayPos = 0;
 
     const FileSystem::File* f = d_fs->findFile(filePath);
     if( f == 0 )
         return false;
     d_stack.push_back(Level());
-    QFile* file = new QFile(filePath);
-    if( !file->open(QIODevice::ReadOnly) )
+    QIODevice* file = d_fs->getStore()->open(filePath);
+    if( file == 0 )
     {
-        delete file;
         d_stack.pop_back();
         return false;
     }
@@ -58,6 +59,19 @@ bool PpLexer::reset(const QString& filePath)
     return true;
 }
 
+void PpLexer::reset(const QList<Token>& toks)
+{
+    d_stack.clear();
+    for( int i = 0; i < d_files.size(); i++ )
+        delete d_files[i];
+    d_files.clear();
+    d_buffer.clear();
+    d_sloc = 0;
+    d_includes.clear();
+    d_replay = toks;
+    d_replayPos = 0;
+}
+
 Token PpLexer::nextToken()
 {
     Token t;
@@ -85,6 +99,8 @@ Token PpLexer::peekToken(quint8 lookAhead)
 
 Token PpLexer::nextTokenImp()
 {
+    if( d_replayPos < d_replay.size() )
+        return d_replay[d_replayPos++];
     if( d_stack.isEmpty() )
         return Token(Tok_Eof);
     Token t = d_stack.back().d_lex.nextToken();
@@ -138,14 +154,19 @@ bool PpLexer::handleInclude(Token t)
     if( fileName.endsWith(".text") )
         fileName.chop(5);
     const FileSystem::File* found = 0;
+    Include inc;
     // TODO: find can still be improved
     if( path.size() == 1 )
     {
+        inc.d_name = fileName;
         found = d_fs->findFile(f->d_dir, QString(), fileName);
     }else if( path.size() == 2 )
+    {
+        inc.d_dir = path[0];
+        inc.d_name = fileName;
         found = d_fs->findFile(f->d_dir, path[0], fileName);
+    }
 
-    Include inc;
     inc.d_inc = found;
     inc.d_loc = RowCol(line,startCol);
     inc.d_sourcePath = t.d_sourcePath;
@@ -155,10 +176,9 @@ bool PpLexer::handleInclude(Token t)
     if( found )
     {
         d_stack.push_back(Level());
-        QFile* file = new QFile(found->d_realPath);
-        if( !file->open(QIODevice::ReadOnly) )
+        QIODevice* file = d_fs->getStore()->open(found->d_realPath);
+        if( file == 0 )
         {
-            delete file;
             d_stack.pop_back();
             d_err = QString("file '%1' cannot be opened").arg(path.join('/')).toUtf8();
         }else
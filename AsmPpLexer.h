@@ -41,12 +41,14 @@ public:
         QString d_sourcePath; // the file where the include lives
         RowCol d_loc; // the pos of the include directive in sourcePath
         quint16 d_len; // the len of the include directive
+        QString d_dir, d_name; // the include spec as looked up relative to sourcePath
     };
 
     PpLexer(FileSystem*);
     ~PpLexer();
 
     bool reset(const QString& filePath);
+    void reset(const QList<Token>&); // replays the tokens, e.g. a chunk of lines lexed before
 
     Token nextToken();
     Token peekToken(quint8 lookAhead = 1);
@@ -108,6 +110,8 @@ private:
     QList<Level> d_stack;
     QList<QIODevice*> d_files;
     QList<Token> d_buffer;
+    QList<Token> d_replay;
+    int d_replayPos;
     QString d_err;
     quint32 d_sloc; // number of lines of code without empty or comment lines
     PpVars d_ppVars;
@@ -35,14 +35,16 @@ struct Token
 #else
         quint8 d_type; // TokenType
 #endif
+    quint8 d_len;
     quint32 d_lineNr : RowCol::ROW_BIT_LEN;
     quint32 d_colNr : RowCol::COL_BIT_LEN -1;
     quint32 d_dotPrefix : 1;
     QString d_sourcePath;
 
     QByteArray d_val;
+    const char* d_id; // lower-case internalized version of d_val for idents, labels and macro calls
     Token(quint16 t = 0, quint32 line = 0, quint16 col = 0, const QByteArray& val = QByteArray()):
-        d_type(t), d_lineNr(line),d_colNr(col),d_val(val),d_dotPrefix(0){}
+        d_type(t), d_len(0),d_lineNr(line),d_colNr(col),d_val(val),d_dotPrefix(0),d_id(0){}
     bool isValid() const { return d_type != Tok_Eof && d_type != Tok_Invalid; }
     RowCol toLoc() const { return RowCol(d_lineNr,d_colNr); }
     static bool isDirective(int t) {
@@ -59,6 +61,7 @@ struct Token
         }
     }
     bool isDirective() const { return isDirective(d_type); }
+    static const char* toId(const char* ident, int len); // shares the ids with Lisa::Token::toId
 };
 }
 
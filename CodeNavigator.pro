@@ -22,13 +22,20 @@ HEADERS += \
     LisaCodeNavigator.h \
     LisaCodeModel.h \
     LisaParser.h \
+    LisaTableParser.h \
+    LisaParserTables.h \
     LisaRowCol.h \
     LisaFileSystem.h \
+    LisaPrefetcher.h \
+    LisaSourceStore.h \
+    LisaArchive.h \
+    LisaFileIndex.h \
     LisaPpLexer.h \
     AsmLexer.h \
     AsmTokenType.h \
     AsmToken.h \
     AsmParser.h \
+    AsmChunkParser.h \
     AsmPpLexer.h \
     AsmSynTree.h
 
@@ -40,12 +47,18 @@ SOURCES += \
     LisaCodeNavigator.cpp \
     LisaCodeModel.cpp \
     LisaParser.cpp \
+    LisaTableParser.cpp \
     LisaToken.cpp \
     LisaFileSystem.cpp \
+    LisaPrefetcher.cpp \
+    LisaSourceStore.cpp \
+    LisaArchive.cpp \
+    LisaFileIndex.cpp \
     LisaPpLexer.cpp \
     AsmLexer.cpp \
     AsmTokenType.cpp \
     AsmParser.cpp \
+    AsmChunkParser.cpp \
     AsmPpLexer.cpp \
     AsmSynTree.cpp
 
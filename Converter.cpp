@@ -16,6 +16,9 @@
 
 #include "Converter.h"
 #include "LisaLexer.h"
+#include "LisaFileSystem.h"
+#include "LisaArchive.h"
+#include <QBuffer>
 #include <QtDebug>
 using namespace Lisa;
 
@@ -34,18 +37,7 @@ using namespace Lisa;
 
 QStringList Converter::collectFiles( const QDir& dir, const QStringList& suffix )
 {
-    QStringList res;
-    QStringList files = dir.entryList( QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name );
-
-    foreach( const QString& f, files )
-        res += collectFiles( QDir( dir.absoluteFilePath(f) ), suffix );
-
-    files = dir.entryList( suffix, QDir::Files, QDir::Name );
-    foreach( const QString& f, files )
-    {
-        res.append(dir.absoluteFilePath(f));
-    }
-    return res;
+    return FileSystem::collectFiles(dir.absolutePath(), suffix);
 }
 
 int Converter::detectPascal( QIODevice* in )
@@ -148,49 +140,77 @@ bool Converter::convert(const QDir& fromDir, const QDir& toDir)
     const QStringList files = collectFiles(fromDir, QStringList() << "*.txt");
     foreach( const QString& f, files )
     {
-        QString newFilePath = toDir.absoluteFilePath(f.mid(off+1).toLower());
-        if( newFilePath.endsWith("text.unix.txt") )
-            newFilePath.chop(13);
-        else if(newFilePath.endsWith("unix.txt") )
-            newFilePath.chop(8);
-        else if(newFilePath.endsWith("txt") )
-            newFilePath.chop(3);
-        const QString name = QFileInfo(f).baseName().toLower();
-        const QString newDirPath = QFileInfo(f).dir().path().mid(off+1).toLower();
-        if( !newDirPath.isEmpty() )
-            toDir.mkpath( newDirPath );
         QFile in(f);
         in.open(QIODevice::ReadOnly);
+        convert(f, off, &in, toDir);
+    }
+    return true;
+}
 
-        const int kind = detectPascal(&in);
-        if( kind == FullUnit )
-            newFilePath += "pas";
-        else if( kind == PartialUnit || kind == AnyPascal )
-        {
-            newFilePath += "inc";
-            //qDebug() << QFileInfo(newFilePath).baseName();
-        }else if( detectScript(&in) )
-            newFilePath += "sh";
-        else if( detectAsm(&in) || name.contains("asm") || name.contains("68k") )
-            newFilePath += "asm";
-        else
-            newFilePath += "txt";
-
-        Q_ASSERT(in.reset());
-        QFile out(newFilePath);
-        if( !out.open(QIODevice::WriteOnly) )
-        {
-            qCritical() << "### cannot open for writing:" << newFilePath;
-            continue;
-        }
-        QByteArray text = in.readAll();
-        if( text.endsWith(0xff) )
-            text.chop(1);
-        if( text.size() != out.write(text) )
-        {
-            qCritical() << "### could not write everything to:" << newFilePath;
+bool Converter::convertArchive(const QString& archivePath, const QDir& toDir)
+{
+    Archive a;
+    if( !a.open(archivePath) )
+    {
+        qCritical() << "###" << a.getError();
+        return false;
+    }
+    const int off = a.getPath().size();
+    const QStringList files = a.collectFiles(QStringList() << "*.txt");
+    const QVector<QByteArray> content = a.read(files);
+    for( int i = 0; i < files.size(); i++ )
+    {
+        if( content[i].isNull() )
             continue;
-        }
+        QBuffer in;
+        in.setData(content[i]);
+        in.open(QIODevice::ReadOnly);
+        convert(files[i], off, &in, toDir);
     }
     return true;
 }
+
+void Converter::convert(const QString& f, int off, QIODevice* in, const QDir& toDir)
+{
+    QString newFilePath = toDir.absoluteFilePath(f.mid(off+1).toLower());
+    if( newFilePath.endsWith("text.unix.txt") )
+        newFilePath.chop(13);
+    else if(newFilePath.endsWith("unix.txt") )
+        newFilePath.chop(8);
+    else if(newFilePath.endsWith("txt") )
+        newFilePath.chop(3);
+    const QString name = QFileInfo(f).baseName().toLower();
+    const QString newDirPath = QFileInfo(f).dir().path().mid(off+1).toLower();
+    if( !newDirPath.isEmpty() )
+        toDir.mkpath( newDirPath );
+
+    const int kind = detectPascal(in);
+    if( kind == FullUnit )
+        newFilePath += "pas";
+    else if( kind == PartialUnit || kind == AnyPascal )
+    {
+        newFilePath += "inc";
+        //qDebug() << QFileInfo(newFilePath).baseName();
+    }else if( detectScript(in) )
+        newFilePath += "sh";
+    else if( detectAsm(in) || name.contains("asm") || name.contains("68k") )
+        newFilePath += "asm";
+    else
+        newFilePath += "txt";
+
+    Q_ASSERT(in->reset());
+    QFile out(newFilePath);
+    if( !out.open(QIODevice::WriteOnly) )
+    {
+        qCritical() << "### cannot open for writing:" << newFilePath;
+        return;
+    }
+    QByteArray text = in->readAll();
+    if( text.endsWith(0xff) )
+        text.chop(1);
+    if( text.size() != out.write(text) )
+    {
+        qCritical() << "### could not write everything to:" << newFilePath;
+        return;
+    }
+}
@@ -28,13 +28,14 @@ public:
     Converter();
     static QStringList collectFiles(const QDir& dir , const QStringList& suffix);
     static bool convert( const QDir& fromDir, const QDir& toDir );
+    static bool convertArchive( const QString& archivePath, const QDir& toDir ); // zip, tar or tar.gz
 
     enum { Unknown, FullUnit, PartialUnit, AnyPascal };
     static int detectPascal( QIODevice* in );
     static bool detectAsm( QIODevice* in );
     static bool detectScript(QIODevice* in );
 private:
-
+    static void convert( const QString& path, int off, QIODevice* in, const QDir& toDir );
 };
 }
 
@@ -0,0 +1,708 @@
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+#include "LisaArchive.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <QtDebug>
+#include <algorithm>
+#include <string.h>
+using namespace Lisa;
+
+static inline quint16 le16(const uchar* p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static inline quint32 le32(const uchar* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (quint32(p[3]) << 24);
+}
+
+namespace
+{
+// Decoder after Mark Adler's puff.c; the canonical Huffman codes are decoded bit by bit, which is
+// fast enough for source files and needs no further tables.
+struct Huffman
+{
+    quint16 d_count[16]; // number of symbols of each code length
+    quint16 d_symbol[288]; // ordered by code
+
+    int construct(const quint16* length, int n)
+    {
+        // returns 0 for a complete code, > 0 for an incomplete and < 0 for an oversubscribed code
+        for( int len = 0; len < 16; len++ )
+            d_count[len] = 0;
+        for( int sym = 0; sym < n; sym++ )
+            d_count[length[sym]]++;
+        if( d_count[0] == n )
+            return 0;
+        int left = 1;
+        for( int len = 1; len < 16; len++ )
+        {
+            left <<= 1;
+            left -= d_count[len];
+            if( left < 0 )
+                return left;
+        }
+        quint16 offs[16];
+        offs[1] = 0;
+        for( int len = 1; len < 15; len++ )
+            offs[len + 1] = offs[len] + d_count[len];
+        for( int sym = 0; sym < n; sym++ )
+            if( length[sym] != 0 )
+                d_symbol[offs[length[sym]]++] = sym;
+        return left;
+    }
+};
+
+struct FixedCodes
+{
+    Huffman d_len, d_dist;
+    FixedCodes()
+    {
+        quint16 lengths[288];
+        int sym = 0;
+        for( ; sym < 144; sym++ )
+            lengths[sym] = 8;
+        for( ; sym < 256; sym++ )
+            lengths[sym] = 9;
+        for( ; sym < 280; sym++ )
+            lengths[sym] = 7;
+        for( ; sym < 288; sym++ )
+            lengths[sym] = 8;
+        d_len.construct(lengths, 288);
+        for( sym = 0; sym < 30; sym++ )
+            lengths[sym] = 5;
+        d_dist.construct(lengths, 30);
+    }
+};
+
+class Inflater
+{
+public:
+    Inflater(const uchar* in, int len, QByteArray& out):
+        d_in(in),d_len(len),d_pos(0),d_bitBuf(0),d_bitCount(0),d_out(out),d_n(0),d_ok(true) {}
+    bool run()
+    {
+        int last;
+        do
+        {
+            last = bits(1);
+            switch( bits(2) )
+            {
+            case 0:
+                stored();
+                break;
+            case 1:
+                {
+                    static const FixedCodes s_fixed;
+                    codes(s_fixed.d_len, s_fixed.d_dist);
+                }
+                break;
+            case 2:
+                dynamic();
+                break;
+            default:
+                fail();
+                break;
+            }
+        }while( d_ok && !last );
+        d_out.resize(d_n);
+        return d_ok;
+    }
+    int getPos() const { return d_pos; }
+private:
+    bool fail()
+    {
+        d_ok = false;
+        return false;
+    }
+    int bits(int need)
+    {
+        quint32 val = d_bitBuf;
+        while( d_bitCount < need )
+        {
+            if( d_pos >= d_len )
+                return fail();
+            val |= quint32(d_in[d_pos++]) << d_bitCount;
+            d_bitCount += 8;
+        }
+        d_bitBuf = val >> need;
+        d_bitCount -= need;
+        return val & ((1u << need) - 1);
+    }
+    void put(char ch)
+    {
+        if( d_n == d_out.size() )
+            d_out.resize(qMax(4096, d_n * 2));
+        d_out.data()[d_n++] = ch;
+    }
+    int decode(const Huffman& h)
+    {
+        int code = 0, first = 0, index = 0;
+        for( int len = 1; len < 16; len++ )
+        {
+            code |= bits(1);
+            const int count = h.d_count[len];
+            if( code - count < first )
+                return h.d_symbol[index + (code - first)];
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+    bool stored()
+    {
+        d_bitBuf = 0;
+        d_bitCount = 0;
+        if( d_pos + 4 > d_len )
+            return fail();
+        const int len = le16(d_in + d_pos);
+        if( quint16(~len) != le16(d_in + d_pos + 2) )
+            return fail();
+        d_pos += 4;
+        if( d_pos + len > d_len )
+            return fail();
+        for( int i = 0; i < len; i++ )
+            put(d_in[d_pos + i]);
+        d_pos += len;
+        return true;
+    }
+    bool codes(const Huffman& lencode, const Huffman& distcode)
+    {
+        static const quint16 s_lens[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const quint8 s_lext[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                           3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const quint16 s_dists[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                             257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                             8193, 12289, 16385, 24577 };
+        static const quint8 s_dext[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                           7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+        int sym;
+        do
+        {
+            sym = decode(lencode);
+            if( sym < 0 || !d_ok )
+                return fail();
+            if( sym < 256 )
+                put(sym);
+            else if( sym > 256 )
+            {
+                sym -= 257;
+                if( sym >= 29 )
+                    return fail();
+                const int len = s_lens[sym] + bits(s_lext[sym]);
+                sym = decode(distcode);
+                if( sym < 0 || sym >= 30 )
+                    return fail();
+                const int dist = s_dists[sym] + bits(s_dext[sym]);
+                if( !d_ok || dist > d_n )
+                    return fail();
+                for( int i = 0; i < len; i++ )
+                    put(d_out.constData()[d_n - dist]);
+            }
+        }while( sym != 256 );
+        return true;
+    }
+    bool dynamic()
+    {
+        static const quint8 s_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+        const int nlen = bits(5) + 257;
+        const int ndist = bits(5) + 1;
+        const int ncode = bits(4) + 4;
+        if( !d_ok || nlen > 286 || ndist > 30 )
+            return fail();
+        quint16 lengths[286 + 30];
+        int index = 0;
+        for( ; index < ncode; index++ )
+            lengths[s_order[index]] = bits(3);
+        for( ; index < 19; index++ )
+            lengths[s_order[index]] = 0;
+        Huffman lencode, distcode;
+        if( lencode.construct(lengths, 19) != 0 )
+            return fail();
+        index = 0;
+        while( index < nlen + ndist )
+        {
+            int sym = decode(lencode);
+            if( sym < 0 || !d_ok )
+                return fail();
+            if( sym < 16 )
+                lengths[index++] = sym;
+            else
+            {
+                quint16 len = 0;
+                if( sym == 16 )
+                {
+                    if( index == 0 )
+                        return fail();
+                    len = lengths[index - 1];
+                    sym = 3 + bits(2);
+                }else if( sym == 17 )
+                    sym = 3 + bits(3);
+                else
+                    sym = 11 + bits(7);
+                if( index + sym > nlen + ndist )
+                    return fail();
+                while( sym-- )
+                    lengths[index++] = len;
+            }
+        }
+        if( lengths[256] == 0 )
+            return fail();
+        // incomplete codes are only allowed for a single length or distance code
+        int left = lencode.construct(lengths, nlen);
+        if( left < 0 || ( left > 0 && nlen - lencode.d_count[0] != 1 ) )
+            return fail();
+        left = distcode.construct(lengths + nlen, ndist);
+        if( left < 0 || ( left > 0 && ndist - distcode.d_count[0] != 1 ) )
+            return fail();
+        return codes(lencode, distcode);
+    }
+
+    const uchar* d_in;
+    int d_len;
+    int d_pos;
+    quint32 d_bitBuf;
+    int d_bitCount;
+    QByteArray& d_out;
+    int d_n; // bytes written to d_out
+    bool d_ok;
+};
+
+struct CrcTable
+{
+    quint32 d_table[256];
+    CrcTable()
+    {
+        for( quint32 i = 0; i < 256; i++ )
+        {
+            quint32 c = i;
+            for( int k = 0; k < 8; k++ )
+                c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            d_table[i] = c;
+        }
+    }
+};
+
+class ReadTask : public QRunnable
+{
+public:
+    ReadTask(const Archive* archive, const QStringList& paths, QByteArray* res, int from, int to):
+        d_archive(archive),d_paths(paths),d_res(res),d_from(from),d_to(to){}
+    void run()
+    {
+        for( int i = d_from; i < d_to; i++ )
+            d_res[i] = d_archive->read(d_paths[i]);
+    }
+private:
+    const Archive* d_archive;
+    const QStringList& d_paths;
+    QByteArray* d_res;
+    int d_from, d_to;
+};
+
+struct Member
+{
+    QList<QByteArray> d_segs; // native encoded, as FileSystem::collectFiles sorts them
+    QString d_path;
+    bool operator<(const Member& rhs) const
+    {
+        // subdirectories before files, each sorted by name
+        int i = 0;
+        while( i < d_segs.size() - 1 && i < rhs.d_segs.size() - 1 && d_segs[i] == rhs.d_segs[i] )
+            i++;
+        const bool isDir = i < d_segs.size() - 1;
+        const bool rhsIsDir = i < rhs.d_segs.size() - 1;
+        if( isDir != rhsIsDir )
+            return isDir;
+        return d_segs[i] < rhs.d_segs[i];
+    }
+};
+}
+
+static QByteArray field(const uchar* p, int max)
+{
+    int len = 0;
+    while( len < max && p[len] != 0 )
+        len++;
+    return QByteArray((const char*)p, len);
+}
+
+static quint32 octal(const uchar* p, int max)
+{
+    quint32 res = 0;
+    for( int i = 0; i < max && p[i] != 0; i++ )
+    {
+        if( p[i] >= '0' && p[i] <= '7' )
+            res = res * 8 + p[i] - '0';
+    }
+    return res;
+}
+
+Archive::Archive():d_data(0),d_size(0)
+{
+
+}
+
+Archive::~Archive()
+{
+    close();
+}
+
+bool Archive::open(const QString& path)
+{
+    close();
+    d_error.clear();
+    d_path = QFileInfo(path).absoluteFilePath();
+    d_file.setFileName(d_path);
+    if( !d_file.open(QIODevice::ReadOnly) )
+        return error(QString("cannot open archive for reading: %1").arg(path));
+    d_size = d_file.size();
+    if( d_size > 0xffffffffLL )
+    {
+        close();
+        return error(QString("archive too large: %1").arg(path));
+    }
+    d_data = d_file.map(0, d_size);
+    if( d_data == 0 )
+    {
+        d_buf = d_file.readAll();
+        d_file.close();
+        d_data = (const uchar*)d_buf.constData();
+        d_size = d_buf.size();
+    }
+    bool ok;
+    if( d_size >= 22 && ( le32(d_data) == 0x04034b50 || le32(d_data) == 0x06054b50 ) )
+        ok = readZip();
+    else if( d_size >= 18 && d_data[0] == 0x1f && d_data[1] == 0x8b )
+        ok = readGzip();
+    else if( d_size >= 512 && ::memcmp(d_data + 257, "ustar", 5) == 0 )
+        ok = readTar();
+    else
+        ok = error(QString("unknown archive format: %1").arg(path));
+    if( !ok )
+        close();
+    return ok;
+}
+
+void Archive::close()
+{
+    d_entries.clear();
+    d_file.close();
+    d_buf.clear();
+    d_data = 0;
+    d_size = 0;
+}
+
+QStringList Archive::collectFiles(const QStringList& suffix) const
+{
+    QStringList suf;
+    foreach( const QString& s, suffix )
+        suf.append(s.startsWith('*') ? s.mid(1) : s);
+    QList<Member> members;
+    QHash<QString,Entry>::const_iterator i;
+    for( i = d_entries.begin(); i != d_entries.end(); ++i )
+    {
+        bool matches = false;
+        foreach( const QString& s, suf )
+        {
+            if( i.key().endsWith(s, Qt::CaseInsensitive) )
+            {
+                matches = true;
+                break;
+            }
+        }
+        if( !matches )
+            continue;
+        Member m;
+        m.d_path = i.key();
+        m.d_segs = QFile::encodeName(i.key().mid(d_path.size() + 1)).split('/');
+        bool hidden = false;
+        foreach( const QByteArray& seg, m.d_segs )
+            hidden = hidden || seg.startsWith('.'); // hidden entries are skipped as with QDir
+        if( !hidden )
+            members.append(m);
+    }
+    std::sort(members.begin(), members.end());
+    QStringList res;
+    foreach( const Member& m, members )
+        res.append(m.d_path);
+    return res;
+}
+
+QByteArray Archive::read(const QString& realPath) const
+{
+    QHash<QString,Entry>::const_iterator i = d_entries.find(realPath);
+    if( i == d_entries.end() )
+        return QByteArray();
+    const Entry& e = i.value();
+    const char* data = (const char*)d_data + e.d_off;
+    if( e.d_method == Unchecked )
+        return QByteArray(data, e.d_size);
+    QByteArray res;
+    if( e.d_method == Stored )
+        res = QByteArray(data, e.d_compSize);
+    else
+        res = inflate(data, e.d_compSize, e.d_size);
+    if( res.isNull() || quint32(res.size()) != e.d_size || crc32(res.constData(), res.size()) != e.d_crc )
+    {
+        qCritical() << "corrupt archive member:" << realPath;
+        return QByteArray();
+    }
+    return res;
+}
+
+bool Archive::getCrc(const QString& realPath, quint32* crc) const
+{
+    QHash<QString,Entry>::const_iterator i = d_entries.find(realPath);
+    if( i == d_entries.end() || i.value().d_method == Unchecked )
+        return false;
+    *crc = i.value().d_crc;
+    return true;
+}
+
+QVector<QByteArray> Archive::read(const QStringList& realPaths) const
+{
+    QVector<QByteArray> res(realPaths.size());
+    QByteArray* out = res.data();
+    QThreadPool pool;
+    const int chunk = 16;
+    for( int i = 0; i < realPaths.size(); i += chunk )
+        pool.start(new ReadTask(this, realPaths, out, i, qMin(i + chunk, realPaths.size())));
+    pool.waitForDone();
+    return res;
+}
+
+bool Archive::isArchive(const QString& path)
+{
+    QFile in(path);
+    if( !in.open(QIODevice::ReadOnly) )
+        return false;
+    const QByteArray head = in.read(512);
+    const uchar* p = (const uchar*)head.constData();
+    if( head.size() >= 4 && ( le32(p) == 0x04034b50 || le32(p) == 0x06054b50 ) )
+        return true;
+    if( head.size() >= 2 && p[0] == 0x1f && p[1] == 0x8b )
+        return true;
+    return head.size() == 512 && ::memcmp(p + 257, "ustar", 5) == 0;
+}
+
+QByteArray Archive::inflate(const char* data, int len, int sizeHint, int* consumed)
+{
+    QByteArray res;
+    if( sizeHint > 0 )
+        res.resize(sizeHint);
+    Inflater inf((const uchar*)data, len, res);
+    if( !inf.run() )
+        return QByteArray();
+    if( consumed )
+        *consumed = inf.getPos();
+    if( res.isNull() )
+        res = QByteArray("");
+    return res;
+}
+
+quint32 Archive::crc32(const char* data, int len)
+{
+    static const CrcTable s_crc;
+    quint32 c = 0xffffffff;
+    for( int i = 0; i < len; i++ )
+        c = s_crc.d_table[(c ^ uchar(data[i])) & 0xff] ^ (c >> 8);
+    return c ^ 0xffffffff;
+}
+
+bool Archive::error(const QString& msg)
+{
+    d_error = msg;
+    return false;
+}
+
+bool Archive::readZip()
+{
+    // the end of central directory record is followed by a comment of at most 64k
+    qint64 eocd = -1;
+    for( qint64 i = d_size - 22; i >= 0 && i >= d_size - 22 - 0xffff; i-- )
+    {
+        if( le32(d_data + i) == 0x06054b50 )
+        {
+            eocd = i;
+            break;
+        }
+    }
+    if( eocd < 0 )
+        return error("zip end of central directory not found");
+    const uchar* e = d_data + eocd;
+    const quint16 count = le16(e + 10);
+    const quint32 cdSize = le32(e + 12);
+    const quint32 cdOff = le32(e + 16);
+    if( count == 0xffff || cdOff == 0xffffffff )
+        return error("zip64 archives are not supported");
+    if( qint64(cdOff) + cdSize > eocd )
+        return error("invalid zip central directory");
+    const uchar* p = d_data + cdOff;
+    const uchar* end = p + cdSize;
+    for( int i = 0; i < count; i++ )
+    {
+        if( p + 46 > end || le32(p) != 0x02014b50 )
+            return error("invalid zip central directory entry");
+        const quint16 flags = le16(p + 8);
+        const quint16 method = le16(p + 10);
+        const quint32 crc = le32(p + 16);
+        const quint32 compSize = le32(p + 20);
+        const quint32 size = le32(p + 24);
+        const quint16 nameLen = le16(p + 28);
+        const quint32 local = le32(p + 42);
+        if( p + 46 + nameLen > end )
+            return error("invalid zip central directory entry");
+        const QByteArray name((const char*)p + 46, nameLen);
+        p += 46 + nameLen + le16(p + 30) + le16(p + 32);
+        if( name.endsWith('/') )
+            continue; // directory
+        if( flags & 1 )
+        {
+            qCritical() << "skipped encrypted zip member" << name;
+            continue;
+        }
+        if( method != Stored && method != Deflated )
+        {
+            qCritical() << "skipped zip member with unsupported compression method" << method << name;
+            continue;
+        }
+        if( qint64(local) + 30 > d_size || le32(d_data + local) != 0x04034b50 )
+            return error("invalid zip local header");
+        const quint32 off = local + 30 + le16(d_data + local + 26) + le16(d_data + local + 28);
+        if( qint64(off) + compSize > d_size )
+            return error("truncated zip archive");
+        // bit 11 indicates UTF-8, otherwise the names are CP437, which is ASCII for the Lisa sources
+        add( flags & 0x800 ? QString::fromUtf8(name) : QString::fromLatin1(name), off, compSize, size, crc, method );
+    }
+    return true;
+}
+
+bool Archive::readTar()
+{
+    QString longName; // of the following member, from a GNU or pax extension header
+    qint64 pos = 0;
+    while( pos + 512 <= d_size )
+    {
+        const uchar* h = d_data + pos;
+        if( h[0] == 0 )
+            break; // end of archive
+        const quint32 size = octal(h + 124, 12);
+        const char type = h[156];
+        const qint64 data = pos + 512;
+        if( data + size > d_size )
+            return error("truncated tar archive");
+        pos = data + ( qint64(size) + 511 ) / 512 * 512;
+        if( type == 'L' )
+            longName = QFile::decodeName(field(d_data + data, size));
+        else if( type == 'x' )
+        {
+            // pax records are of the form "<len> <key>=<value>\n"
+            quint32 i = 0;
+            while( i < size )
+            {
+                const QByteArray rec = field(d_data + data + i, size - i);
+                const int sp = rec.indexOf(' ');
+                const int len = rec.left(sp).toInt();
+                if( sp < 0 || len <= sp || i + len > size )
+                    break;
+                const QByteArray kv = rec.mid(sp + 1, len - sp - 2);
+                if( kv.startsWith("path=") )
+                    longName = QString::fromUtf8(kv.mid(5));
+                i += len;
+            }
+        }else if( type == '0' || type == 0 )
+        {
+            QString name = longName;
+            if( name.isEmpty() )
+            {
+                QByteArray n = field(h, 100);
+                const QByteArray prefix = field(h + 345, 155);
+                if( ::memcmp(h + 257, "ustar", 5) == 0 && !prefix.isEmpty() )
+                    n = prefix + '/' + n;
+                name = QFile::decodeName(n);
+            }
+            add(name, data, size, size, 0, Unchecked);
+            longName.clear();
+        }else
+            longName.clear(); // directories, links and the like
+    }
+    return true;
+}
+
+bool Archive::readGzip()
+{
+    const uchar* p = d_data;
+    if( p[2] != 8 )
+        return error("unsupported gzip compression method");
+    const uchar flags = p[3];
+    qint64 pos = 10;
+    if( flags & 4 )
+        pos += 2 + le16(p + pos); // extra field
+    if( flags & 8 )
+        while( pos < d_size && p[pos++] != 0 )
+            ; // file name
+    if( flags & 16 )
+        while( pos < d_size && p[pos++] != 0 )
+            ; // comment
+    if( flags & 2 )
+        pos += 2; // header crc
+    if( pos + 8 > d_size )
+        return error("truncated gzip archive");
+    int used = 0;
+    const quint32 isize = le32(p + d_size - 4);
+    const QByteArray tar = inflate((const char*)p + pos, d_size - pos, qMin<quint32>(isize, 1 << 28), &used);
+    if( tar.isNull() )
+        return error("corrupt gzip archive");
+    if( pos + used + 8 > d_size || le32(p + pos + used) != crc32(tar.constData(), tar.size()) )
+        return error("gzip checksum mismatch");
+    d_file.close();
+    d_buf = tar;
+    d_data = (const uchar*)d_buf.constData();
+    d_size = d_buf.size();
+    return readTar();
+}
+
+void Archive::add(const QString& name, quint32 off, quint32 compSize, quint32 size, quint32 crc, quint16 method)
+{
+    QString n = name;
+    while( n.startsWith("./") )
+        n = n.mid(2);
+    while( n.startsWith('/') )
+        n = n.mid(1);
+    if( n.isEmpty() )
+        return;
+    if( QString(n).replace('\\','/').split('/').contains("..") || QDir::isAbsolutePath(n) )
+    {
+        // would be extracted outside of the directory the archive is converted to
+        qCritical() << "skipped archive member with a path outside of the archive" << name;
+        return;
+    }
+    Entry e;
+    e.d_off = off;
+    e.d_compSize = compSize;
+    e.d_size = size;
+    e.d_crc = crc;
+    e.d_method = method;
+    d_entries.insert(d_path + '/' + n, e);
+}
@@ -0,0 +1,78 @@
+#ifndef LISAARCHIVE_H
+#define LISAARCHIVE_H
+
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+#include <QFile>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+namespace Lisa
+{
+// Read-only view of a zip, tar or tar.gz archive, so a source tree can be used without extracting it.
+// The members are addressed by virtual real paths, i.e. the path of the archive followed by the
+// path of the member, e.g. "/home/me/lisa.zip/LISA_OS/LIBS/LIBPL-PASLIB.TEXT.unix.txt".
+// Zip members are inflated on each read; tar.gz archives are inflated once when opened.
+class Archive
+{
+public:
+    Archive();
+    ~Archive();
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return d_data != 0; }
+    const QString& getPath() const { return d_path; }
+    const QString& getError() const { return d_error; }
+
+    // the members with one of the suffix ("*.suf", case insensitive) in the order of FileSystem::collectFiles
+    QStringList collectFiles(const QStringList& suffix) const;
+    bool contains(const QString& realPath) const { return d_entries.contains(realPath); }
+    QByteArray read(const QString& realPath) const; // null if no member or corrupt
+    QVector<QByteArray> read(const QStringList& realPaths) const; // inflated in parallel
+    bool getCrc(const QString& realPath, quint32* crc) const; // from the zip directory; false for tar members
+
+    static bool isArchive(const QString& path); // checks the signature, not the suffix
+    // raw deflate stream (RFC 1951); null on error; consumed is set to the bytes used from data
+    static QByteArray inflate(const char* data, int len, int sizeHint = 0, int* consumed = 0);
+    static quint32 crc32(const char* data, int len);
+private:
+    bool error(const QString&);
+    bool readZip();
+    bool readTar();
+    bool readGzip();
+    void add(const QString& name, quint32 off, quint32 compSize, quint32 size, quint32 crc, quint16 method);
+    enum Method { Stored = 0, Deflated = 8, Unchecked = 0xffff }; // Unchecked: stored, no crc (tar)
+    struct Entry
+    {
+        quint32 d_off; // of the member data
+        quint32 d_compSize;
+        quint32 d_size;
+        quint32 d_crc;
+        quint16 d_method;
+    };
+    QHash<QString,Entry> d_entries;
+    QString d_path;
+    QString d_error;
+    QFile d_file;
+    QByteArray d_buf; // the content if not mapped or inflated from tar.gz
+    const uchar* d_data;
+    qint64 d_size;
+};
+}
+
+#endif // LISAARCHIVE_H
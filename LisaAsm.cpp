@@ -16,57 +16,58 @@
 
 #include "AsmPpLexer.h"
 #include "AsmParser.h"
+#include "AsmChunkParser.h"
+#include "LisaTreeWriter.h"
+#include "LisaFileSystem.h"
 #include <QCoreApplication>
 #include <QDir>
 #include <QFile>
 #include <QtDebug>
+#include <QElapsedTimer>
+#include <QThreadPool>
 
-static void dump(QTextStream& out, const Asm::SynTree* node, int level)
+static QList<QByteArray> treeNames()
 {
-    QByteArray str;
-    if( node->d_tok.d_type == Asm::Tok_Invalid )
-        level--;
-    else if( node->d_tok.d_type < Asm::SynTree::R_First )
+    QList<QByteArray> res;
+    for( int i = 0; i < Asm::SynTree::R_Last; i++ )
     {
-        if( Asm::tokenTypeIsKeyword( node->d_tok.d_type ) )
-            str = Asm::tokenTypeString(node->d_tok.d_type);
-        else if( node->d_tok.d_type > Asm::TT_Specials )
-            str = QByteArray("\"") + node->d_tok.d_val + QByteArray("\"");
+        if( i < Asm::TT_Max )
+            res << Asm::tokenTypeString(i);
+        else if( i > Asm::SynTree::R_First )
+            res << Asm::SynTree::rToStr(i);
         else
-            str = QByteArray("\"") + Asm::tokenTypeString(node->d_tok.d_type) + QByteArray("\"");
-
-    }else
-        str = Asm::SynTree::rToStr( node->d_tok.d_type );
-    if( !str.isEmpty() )
-    {
-        str += QByteArray("\t") + QFileInfo(node->d_tok.d_sourcePath).baseName().toUtf8() +
-                ":" + QByteArray::number(node->d_tok.d_lineNr) +
-                ":" + QByteArray::number(node->d_tok.d_colNr);
-        QByteArray ws;
-        for( int i = 0; i < level; i++ )
-            ws += "|  ";
-        str = ws + str;
-        out << str.data() << endl;
+            res << QByteArray();
     }
-    foreach( Asm::SynTree* sub, node->d_children )
-        dump( out, sub, level + 1 );
+    return res;
 }
 
-QStringList collectFiles( const QDir& dir, const QStringList& suffix )
+struct Parse
 {
-    QStringList res;
-    QStringList files = dir.entryList( QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name );
-
-    foreach( const QString& f, files )
-        res += collectFiles( QDir( dir.absoluteFilePath(f) ), suffix );
+    Asm::SynTree d_root;
+    QList<Asm::Parser::Error> d_errors;
+};
 
-    files = dir.entryList( suffix, QDir::Files, QDir::Name );
-    foreach( const QString& f, files )
+class ParseTask : public QRunnable
+{
+public:
+    ParseTask(Lisa::FileSystem* fs, const Lisa::FileSystem::File* f, Parse* res, QThreadPool* pool):
+        d_fs(fs),d_file(f),d_res(res),d_pool(pool){}
+    void run()
     {
-        res.append(dir.absoluteFilePath(f));
+        Asm::ChunkParser p(d_fs, d_pool);
+        //qDebug() << "**** parsing" << file;
+        p.RunParser(d_file->d_realPath);
+        d_res->d_root.d_tok = p.d_root.d_tok;
+        d_res->d_root.d_children = p.d_root.d_children;
+        p.d_root.d_children.clear();
+        d_res->d_errors = p.errors;
     }
-    return res;
-}
+private:
+    Lisa::FileSystem* d_fs;
+    const Lisa::FileSystem::File* d_file;
+    Parse* d_res;
+    QThreadPool* d_pool;
+};
 
 int main(int argc, char *argv[])
 {
@@ -79,7 +80,7 @@ int main(int argc, char *argv[])
     QStringList files;
 
     if( QFileInfo(a.arguments()[1]).isDir() )
-        files = collectFiles(a.arguments()[1],QStringList() << "*.asm");
+        files = Lisa::FileSystem::collectFiles(a.arguments()[1],QStringList() << "*.asm");
     else
         files << a.arguments()[1];
 
@@ -116,20 +117,33 @@ int main(int argc, char *argv[])
         }
     }
 #else
+    // "-syn <dir>" additionally writes the syntax trees to .syn files, see LisaTreeStream.h
+    const bool syn = a.arguments()[1] == "-syn" && a.arguments().size() > 2;
     Lisa::FileSystem fs;
-    fs.load(a.arguments()[1]);
+    fs.load(a.arguments()[syn ? 2 : 1]);
+    if( syn && fs.isArchive() )
+    {
+        qCritical() << "cannot write .syn files into an archive, extract it first:" << a.arguments()[2];
+        return -1;
+    }
     QList<const Lisa::FileSystem::File*> files = fs.getAllAsm();
+    const QList<QByteArray> names = treeNames();
+    QElapsedTimer timer;
+    timer.start();
+    // the files are parsed in parallel, but reported and written in order
+    QVector<Parse> parses(files.size());
+    QThreadPool pool;
+    for( int i = 0; i < files.size(); i++ )
+        pool.start(new ParseTask(&fs, files[i], &parses[i], &pool));
+    pool.waitForDone();
     int ok = 0;
-    foreach( const Lisa::FileSystem::File* f, files )
+    for( int i = 0; i < files.size(); i++ )
     {
-        Asm::PpLexer lex(&fs);
-        lex.reset(f->d_realPath);
-        Asm::Parser p(&lex);
-        //qDebug() << "**** parsing" << file;
-        p.RunParser();
-        if( !p.errors.isEmpty() )
+        const Lisa::FileSystem::File* f = files[i];
+        const Parse& p = parses[i];
+        if( !p.d_errors.isEmpty() )
         {
-            foreach( const Asm::Parser::Error& e, p.errors )
+            foreach( const Asm::Parser::Error& e, p.d_errors )
                 qCritical() << f->getVirtualPath() << e.row << e.col << e.msg;
 
         }else
@@ -137,15 +151,17 @@ int main(int argc, char *argv[])
             ok++;
             //qDebug() << "ok";
         }
-#if 0
-        QFile out(f->d_realPath + ".st");
-        out.open(QIODevice::WriteOnly);
-        QTextStream s(&out);
-        dump(s,&p.d_root,0);
-#endif
+        if( syn )
+        {
+            Lisa::TreeStreamWriter w(fs.getRootPath(), Asm::SynTree::R_First, names);
+            w.add(&p.d_root);
+            if( !w.write(f->d_realPath + ".syn") )
+                qCritical() << "cannot open file for writing:" << f->d_realPath + ".syn";
+        }
     }
 #endif
-    qDebug() << "#### finished with" << ok << "files ok of total" << files.size() << "files";
+    qDebug() << "#### finished with" << ok << "files ok of total" << files.size() << "files in"
+             << timer.elapsed() << "[ms] on" << pool.maxThreadCount() << "threads";
 
     return 0;
 }
@@ -17,7 +17,11 @@ SOURCES += \
     AsmPpLexer.cpp \
     AsmSynTree.cpp \
     AsmParser.cpp \
+    AsmChunkParser.cpp \
     LisaFileSystem.cpp \
+    LisaPrefetcher.cpp \
+    LisaSourceStore.cpp \
+    LisaArchive.cpp \
     LisaLexer.cpp \
     LisaTokenType.cpp \
     LisaToken.cpp
@@ -29,9 +33,15 @@ HEADERS += \
     AsmPpLexer.h \
     AsmSynTree.h \
     AsmParser.h \
+    AsmChunkParser.h \
     LisaFileSystem.h \
+    LisaPrefetcher.h \
+    LisaSourceStore.h \
+    LisaArchive.h \
     LisaLexer.h \
     LisaTokenType.h \
-    LisaToken.h
+    LisaToken.h \
+    LisaTreeStream.h \
+    LisaTreeWriter.h
 
 
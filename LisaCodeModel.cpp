@@ -19,13 +19,18 @@
 
 #include "LisaCodeModel.h"
 #include "LisaPpLexer.h"
-#include "LisaParser.h" 
+#include "LisaPrefetcher.h"
+#include "LisaTableParser.h"
 #include "AsmPpLexer.h"
 #include "AsmParser.h"
+#include "AsmChunkParser.h"
 #include <QFile>
 #include <QPixmap>
 #include <QtDebug>
 #include <QCoreApplication>
+#include <QScopedPointer>
+#include <QThreadPool>
+#include <string.h>
 using namespace Lisa;
 
 #define LISA_WITH_MISSING
@@ -39,15 +44,16 @@ class PascalModelVisitor
     struct Deferred
     {
         Symbol* sym;
-        Type::Ref pointer;
+        Type* pointer;
         Scope* scope;
         SynTree* typeIdent;
     };
     QList<Deferred> d_deferred;
     QList<Declaration*> d_forwards;
+    bool d_reparse;
 
 public:
-    PascalModelVisitor(CodeModel* m):d_mdl(m) {}
+    PascalModelVisitor(CodeModel* m):d_mdl(m),d_reparse(false) {}
 
     void visit( UnitFile* cf, SynTree* top )
     {      
@@ -72,10 +78,80 @@ public:
             break;
         }
     }
+
+    // the declaration of a routine is only created if it has a heading
+    static bool hasHeading( const SynTree* st )
+    {
+        foreach( const SynTree* s, st->d_children )
+            if( s->d_tok.d_type == SynTree::R_procedure_heading || s->d_tok.d_type == SynTree::R_function_heading )
+                return true;
+        return false;
+    }
+
+    // st is the new procedure or function declaration of routine, which must have a heading; routine
+    // gets the new body and symbols, but stays the same object, so the references from outside remain valid
+    void reparse( UnitFile* cf, Declaration* routine, SynTree* st )
+    {
+        d_cf = cf;
+        d_reparse = true;
+        Scope* scope = routine->d_owner;
+        Declaration* twin = 0;
+        if( routine->d_me && routine->d_me->d_decl != routine )
+            twin = static_cast<Declaration*>(routine->d_me->d_decl);
+        if( twin )
+            d_forwards.append(twin);
+        if( cf->d_impl )
+        {
+            foreach( Declaration* d, cf->d_impl->d_order )
+                if( ( d->d_kind == Thing::Proc || d->d_kind == Thing::Func ) && d->d_me &&
+                        d->d_me->d_decl && d->d_me->d_decl != d )
+                    d_redirect[d] = static_cast<Declaration*>(d->d_me->d_decl);
+        }
+
+        // hide the declarations which were not yet visible when the routine was visited the first time
+        QList< QPair<Scope*,QList<Declaration*> > > hidden;
+        Declaration* inner = routine;
+        for( Scope* s = scope; s && inner; s = s->d_outer )
+        {
+            int i = s->d_order.indexOf(inner);
+            if( i < 0 )
+                break; // e.g. the members of a class, which were complete when the method was visited
+            if( inner != routine )
+                i++;
+            hidden.append( qMakePair(s, s->d_order.mid(i)) );
+            s->d_order.erase(s->d_order.begin() + i, s->d_order.end());
+            inner = s->d_owner && s->d_owner->isDeclaration() ? static_cast<Declaration*>(s->d_owner) : 0;
+        }
+        const int count = scope->d_order.size();
+        func_proc_declaration(scope, st, routine->d_kind);
+        Declaration* d = scope->d_order.size() > count ? scope->d_order.takeLast() : 0;
+        for( int i = 0; i < hidden.size(); i++ )
+            hidden[i].first->d_order += hidden[i].second;
+        Q_ASSERT( d );
+
+        routine->d_body = d->d_body;
+        routine->d_body->d_owner = routine;
+        routine->d_type = d->d_type;
+        routine->d_loc = d->d_loc;
+        routine->d_me = d->d_me;
+        for( Declaration::Refs::const_iterator i = d->d_refs.begin(); i != d->d_refs.end(); ++i )
+        {
+            foreach( Symbol* sy, i.value() )
+            {
+                sy->d_decl = routine;
+                routine->d_refs[i.key()].append(sy);
+            }
+        }
+        if( twin )
+            twin->d_impl = routine;
+        d_mdl->getCalls()->replace(d, routine);
+        if( cf->d_stream && cf->d_stream->d_routines.contains(d) )
+            cf->d_stream->d_routines.insert(routine, cf->d_stream->d_routines.take(d));
+    }
 private:
     void program( UnitFile* cf, SynTree* st )
     {
-        Scope* s = new Scope();
+        Scope* s = cf->d_arena.newScope();
         s->d_owner = cf;
         s->d_kind = Thing::Body;
         cf->d_impl = s;
@@ -144,7 +220,7 @@ private:
     }
     Scope* interface_part( UnitFile* cf, SynTree* st )
     {
-        Scope* newScope = new Scope();
+        Scope* newScope = cf->d_arena.newScope();
         newScope->d_owner = cf;
         newScope->d_kind = Thing::Interface;
         cf->d_intf = newScope;
@@ -175,7 +251,7 @@ private:
     }
     void implementation_part( UnitFile* cf, Scope* intf, SynTree* st )
     {
-        Scope* newScope = new Scope();
+        Scope* newScope = cf->d_arena.newScope();
         newScope->d_owner = cf;
         newScope->d_kind = Thing::Implementation;
         newScope->d_outer = intf;
@@ -215,7 +291,7 @@ private:
                 {
                     Declaration* mb = addDecl(scope,s->d_tok,Thing::MethBlock, cls);
 
-                    mb->d_body = new Scope();
+                    mb->d_body = d_cf->d_arena.newScope();
                     mb->d_body->d_kind = Thing::Members;
                     mb->d_body->d_outer = cls->d_type->d_members;
                     mb->d_body->d_altOuter = scope;
@@ -344,7 +420,7 @@ private:
     }
     Declaration* addDecl(Scope* scope, const Token& t, int type, Declaration* cls = 0 )
     {
-        Declaration* d = new Declaration();
+        Declaration* d = d_cf->d_arena.newDecl();
         d->d_kind = type;
         d->d_name = t.d_val;
         d->d_id = t.d_id;
@@ -362,7 +438,7 @@ private:
 
         Declaration* fwd = 0;
 
-        Symbol* sy = new Symbol();
+        Symbol* sy = d_cf->d_arena.newSym();
         sy->d_loc = t.toLoc();
         d_cf->d_syms[t.d_sourcePath].append(sy);
         d->d_me = sy;
@@ -403,15 +479,17 @@ private:
                 d = addDecl(scope, s->d_tok, Thing::TypeDecl);
             if( s->d_tok.d_type == SynTree::R_type_)
             {
-                Type::Ref t = type_(scope,s);
+                Type* t = type_(scope,s);
                 if( d )
                     d->d_type = t;
+                if( d && t && t->d_kind == Type::Class && !d_reparse ) // classes are declared on unit level
+                    d_mdl->getClasses()->addClass(d);
             }
         }
     }
-    Type::Ref type_( Scope* scope, SynTree* st)
+    Type* type_( Scope* scope, SynTree* st)
     {
-        Type::Ref res;
+        Type* res = 0;
         foreach( SynTree* s, st->d_children )
         {
             if( s->d_tok.d_type == SynTree::R_simple_type)
@@ -425,9 +503,9 @@ private:
         }
         return res;
     }
-    Type::Ref resolvedType(Symbol* sym)
+    Type* resolvedType(Symbol* sym)
     {
-        Type::Ref res;
+        Type* res = 0;
         if( sym && sym->d_decl && sym->d_decl->d_kind == Thing::TypeDecl )
         {
             Declaration* d = static_cast<Declaration*>(sym->d_decl);
@@ -435,14 +513,14 @@ private:
         }
         return res;
     }
-    Type::Ref createAlias(Symbol* sym)
+    Type* createAlias(Symbol* sym)
     {
         return resolvedType(sym);
     }
 
-    Type::Ref simple_type(Scope* scope, SynTree* st)
+    Type* simple_type(Scope* scope, SynTree* st)
     {
-        Type::Ref res;
+        Type* res = 0;
         foreach( SynTree* s, st->d_children )
         {
             if( s->d_tok.d_type == Tok_identifier)
@@ -482,9 +560,9 @@ private:
             if( s->d_tok.d_type == Tok_identifier)
                 addSym(scope,s->d_tok);
     }
-    Type::Ref structured_type(Scope* scope, SynTree* st)
+    Type* structured_type(Scope* scope, SynTree* st)
     {
-        Type::Ref res;
+        Type* res = 0;
         foreach( SynTree* s, st->d_children )
         {
             if( s->d_tok.d_type == SynTree::R_array_type)
@@ -500,9 +578,9 @@ private:
         }
         return res;
     }
-    Type::Ref array_type(Scope* scope, SynTree* st)
+    Type* array_type(Scope* scope, SynTree* st)
     {
-        Type::Ref t;
+        Type* t = 0;
         foreach( SynTree* s, st->d_children )
         {
             if( s->d_tok.d_type == SynTree::R_index_type && !s->d_children.isEmpty())
@@ -511,13 +589,8 @@ private:
                 t = type_(scope,s);
         }
         if( t )
-        {
-            Type::Ref ptr( new Type() );
-            ptr->d_kind = Type::Array;
-            ptr->d_type = t;
-            return ptr;
-        }
-        return Type::Ref();
+            return d_mdl->getTypes()->shared(Type::Array,t);
+        return 0;
     }
     void ordinal_type(Scope* scope, SynTree* st)
     {
@@ -525,11 +598,10 @@ private:
             if( s->d_tok.d_type == SynTree::R_simple_type)
                 simple_type(scope,s);
     }
-    Type::Ref record_type(Scope* scope, SynTree* st)
+    Type* record_type(Scope* scope, SynTree* st)
     {
-        Type::Ref rec(new Type());
-        rec->d_kind = Type::Record;
-        rec->d_members = new Scope();
+        Type* rec = d_mdl->getTypes()->create(Type::Record);
+        rec->d_members = d_cf->d_arena.newScope();
         rec->d_members->d_kind = Thing::Members;
         rec->d_members->d_outer = scope;
         foreach( SynTree* s, st->d_children )
@@ -556,7 +628,7 @@ private:
     void field_declaration(Scope* scope, SynTree* st)
     {
         QList<Declaration*> fields;
-        Type::Ref t;
+        Type* t = 0;
         foreach( SynTree* s, st->d_children )
         {
             if( s->d_tok.d_type == SynTree::R_identifier_list)
@@ -610,18 +682,17 @@ private:
             if( s->d_tok.d_type == SynTree::R_type_)
                 type_(scope,s);
     }
-    Type::Ref class_type(Scope* scope, SynTree* st)
+    Type* class_type(Scope* scope, SynTree* st)
     {
-        Type::Ref rec(new Type());
-        rec->d_kind = Type::Class;
-        rec->d_members = new Scope();
+        Type* rec = d_mdl->getTypes()->create(Type::Class);
+        rec->d_members = d_cf->d_arena.newScope();
         rec->d_members->d_kind = Thing::Members;
         rec->d_members->d_outer = scope;
         foreach( SynTree* s, st->d_children )
         {
             if( s->d_tok.d_type == SynTree::R_type_identifier)
             {
-                Type::Ref super = resolvedType(type_identifier(scope,s));
+                Type* super = resolvedType(type_identifier(scope,s));
                 if( super && super->d_kind == Type::Class )
                 {
                     rec->d_type = super;
@@ -658,7 +729,7 @@ private:
         def.typeIdent = typeIdent;
         d_deferred.append(def);
     }
-    Type::Ref pointer_type(Scope* scope, SynTree* st)
+    Type* pointer_type(Scope* scope, SynTree* st)
     {
         Symbol* sym = 0;
         SynTree* id = 0;
@@ -668,15 +739,16 @@ private:
                 id = s;
                 sym = type_identifier(scope,id);
             }
-        Type::Ref t = resolvedType(sym);
+        Type* t = resolvedType(sym);
 
-        Type::Ref ptr(new Type());
-        ptr->d_kind = Type::Pointer;
-        ptr->d_type = t;
-
-        if( t.data() == 0 || sym == 0 || sym->d_decl == 0 )
-            defer( sym, ptr.data(), scope, id );
-        return ptr;
+        if( t == 0 || sym == 0 || sym->d_decl == 0 )
+        {
+            // the deferred pointer is patched later, so it cannot be shared
+            Type* ptr = d_mdl->getTypes()->create(Type::Pointer,t);
+            defer( sym, ptr, scope, id );
+            return ptr;
+        }else
+            return d_mdl->getTypes()->shared(Type::Pointer,t);
     }
     void variable_declaration_part( Scope* scope, SynTree* st)
     {
@@ -687,7 +759,7 @@ private:
     void variable_declaration(Scope* scope, SynTree* st)
     {
         QList<Declaration*> vars;
-        Type::Ref t;
+        Type* t = 0;
         foreach( SynTree* s, st->d_children )
         {
             if( s->d_tok.d_type == SynTree::R_identifier_list)
@@ -744,6 +816,25 @@ private:
             d_forwards.append(d);
         else if( attr == ExternalAttr && d )
             linkToAsm(d, body);
+        if( d && d_cf->d_stream )
+        {
+            const SynTree* last = lastTerminal(st);
+            const QString& path = d_cf->d_file->d_realPath;
+            if( last && st->d_tok.d_sourcePath == path && last->d_tok.d_sourcePath == path )
+                d_cf->d_stream->d_routines.insert(d, Range(st->d_tok.toLoc(), last->d_tok.toLoc()));
+        }
+    }
+    static const SynTree* lastTerminal(const SynTree* st)
+    {
+        if( st->d_tok.d_type < SynTree::R_First )
+            return st;
+        for( int i = st->d_children.size() - 1; i >= 0; i-- )
+        {
+            const SynTree* res = lastTerminal(st->d_children[i]);
+            if( res )
+                return res;
+        }
+        return 0;
     }
     Declaration* findAsm(const char* id)
     {
@@ -772,19 +863,23 @@ private:
         foreach( SynTree* s, body->d_children )
             if( s->d_tok.d_type == Tok_external )
             {
-                Symbol* sy = new Symbol();
+                Symbol* sy = d_cf->d_arena.newSym();
                 sy->d_loc = s->d_tok.toLoc();
                 d_cf->d_syms[s->d_tok.d_sourcePath].append(sy);
                 sy->d_decl = ext;
                 if( ext )
+                {
                     ext->d_refs[s->d_tok.d_sourcePath].append(sy);
+                    // the external declaration is a trampoline to the assembler implementation
+                    d_mdl->getCalls()->addCall(d, ext, FilePos(sy->d_loc,s->d_tok.d_sourcePath));
+                }
             }
     }
     Declaration* func_proc_heading(Scope* scope, SynTree* st, int type)
     {
         Token id = findIdent(st);
         Declaration* d = addDecl(scope,id, type);
-        d->d_body = new Scope();
+        d->d_body = d_cf->d_arena.newScope();
         d->d_body->d_kind = Thing::Body;
         d->d_body->d_owner = d;
         d->d_body->d_outer = scope;
@@ -838,7 +933,7 @@ private:
         }
         if( id )
         {
-            Type::Ref t  = createAlias(id); // t is potentially an alias
+            Type* t  = createAlias(id); // t is potentially an alias
             for( int i = 0; i < vars.size(); i++ )
                 vars[i]->d_type = t;
         }
@@ -860,7 +955,7 @@ private:
                     d = intf.value(); // attach all refs to the interface declaration (otherwise they are not visible)
                 }
             }
-            Symbol* sy = new Symbol();
+            Symbol* sy = d_cf->d_arena.newSym();
             sy->d_loc = t.toLoc();
             d_cf->d_syms[t.d_sourcePath].append(sy);
             sy->d_decl = d;
@@ -870,6 +965,33 @@ private:
         }else
             return 0;
     }
+    Thing* enclosingRoutine(Scope* scope)
+    {
+        while( scope )
+        {
+            if( scope->d_kind == Thing::Body && scope->d_owner )
+            {
+                if( scope->d_owner->isDeclaration() )
+                {
+                    // use the interface, forward or class member twin, like the refs do
+                    Declaration* d = static_cast<Declaration*>(scope->d_owner);
+                    if( d->d_me && d->d_me->d_decl )
+                        return d->d_me->d_decl;
+                }
+                return scope->d_owner;
+            }
+            scope = scope->d_outer;
+        }
+        return d_cf;
+    }
+    void addCall(Scope* scope, Symbol* sym, const Token& t)
+    {
+        if( sym == 0 || sym->d_decl == 0 ||
+                ( sym->d_decl->d_kind != Thing::Func && sym->d_decl->d_kind != Thing::Proc ) )
+            return;
+        d_mdl->getCalls()->addCall(enclosingRoutine(scope), static_cast<Declaration*>(sym->d_decl),
+                                   FilePos(sym->d_loc,t.d_sourcePath));
+    }
     Symbol* type_identifier(Scope* scope, SynTree* st)
     {
         Symbol* res = 0;
@@ -1065,17 +1187,20 @@ private:
                     if( types[i] && types[i]->d_members )
                         tmp.d_order += types[i]->d_members->d_order; // borrow decls from records
                 }
-                statement(&tmp,s); // this needs a prepared scope
-                tmp.d_order.clear(); // avoid that Scope deletes the temporarily borrowed decls
+                statement(&tmp,s); // this needs a prepared scope; the borrowed decls are owned by the arena
             }
         }
     }
     void assigOrCall(Scope* scope, SynTree* st)
     {
+        bool isAssig = false; // the assigned function name in its body is no call
+        foreach( SynTree* s, st->d_children )
+            if( s->d_tok.d_type == SynTree::R_expression)
+                isAssig = true;
         foreach( SynTree* s, st->d_children )
         {
             if( s->d_tok.d_type == SynTree::R_variable_reference)
-                variable_reference(scope,s);
+                variable_reference(scope,s,!isAssig);
             if( s->d_tok.d_type == SynTree::R_expression)
                 expression(scope,s);
         }
@@ -1137,8 +1262,9 @@ private:
             if( s->d_tok.d_type == Tok_identifier)
             {
                 Symbol* sym = addSym(scope,s->d_tok);
+                addCall(scope,sym,s->d_tok);
                 if( sym && sym->d_decl && sym->d_decl->isDeclaration() )
-                    t = static_cast<Declaration*>(sym->d_decl)->d_type.data();
+                    t = static_cast<Declaration*>(sym->d_decl)->d_type;
             }
             if( s->d_tok.d_type == SynTree::R_factor)
                 factor(scope,s);
@@ -1146,7 +1272,7 @@ private:
                 t = qualifier(scope,s,t);
         }
     }
-    Type* variable_reference(Scope* scope, SynTree* st)
+    Type* variable_reference(Scope* scope, SynTree* st, bool mayCall = true)
     {
         Type* t = 0;
         foreach( SynTree* s, st->d_children )
@@ -1154,8 +1280,10 @@ private:
             if( s->d_tok.d_type == SynTree::R_variable_identifier && !s->d_children.isEmpty())
             {
                 Symbol* sym = addSym(scope,s->d_children.first()->d_tok);
+                if( mayCall )
+                    addCall(scope,sym,s->d_children.first()->d_tok);
                 if( sym && sym->d_decl && sym->d_decl->isDeclaration() )
-                    t = static_cast<Declaration*>(sym->d_decl)->d_type.data();
+                    t = static_cast<Declaration*>(sym->d_decl)->d_type;
                 // if decl is a Func/Proc, t is the return type
             }
             if( s->d_tok.d_type == SynTree::R_qualifier)
@@ -1168,7 +1296,7 @@ private:
     Type* dereferencer(Type* t)
     {
         if( t && t->d_kind == Type::Pointer )
-            return t->d_type.data();
+            return t->d_type;
         else
             return 0;
     }
@@ -1194,7 +1322,7 @@ private:
                 index(scope,s);
                 // if t is an array, the t->d_type is the element type
                 if( t && t->d_kind == Type::Array )
-                    res = t->d_type.data();
+                    res = t->d_type;
             }
             if( s->d_tok.d_type == SynTree::R_field_designator)
                 res = field_designator(scope,s,t);
@@ -1212,8 +1340,9 @@ private:
                 if( s->d_tok.d_type == SynTree::R_field_identifier && !s->d_children.isEmpty() )
                 {
                     Symbol* sym = addSym(t->d_members,s->d_children.first()->d_tok);
+                    addCall(scope,sym,s->d_children.first()->d_tok); // method call
                     if( sym && sym->d_decl && sym->d_decl->isDeclaration() )
-                        res = static_cast<Declaration*>(sym->d_decl)->d_type.data();
+                        res = static_cast<Declaration*>(sym->d_decl)->d_type;
                 }
         }
         return res;
@@ -1238,14 +1367,16 @@ class AsmModelVisitor
 {
     CodeModel* d_mdl;
     AsmFile* d_cf;
+    Declaration* d_proc; // the .PROC or .FUNC the current line belongs to
 
 public:
-    AsmModelVisitor(CodeModel* m):d_mdl(m) {}
+    AsmModelVisitor(CodeModel* m):d_mdl(m),d_proc(0) {}
 
     void visit( AsmFile* cf, Asm::SynTree* top )
     {
         d_cf = cf;
-        cf->d_impl = new Scope();
+        d_proc = 0;
+        cf->d_impl = cf->d_arena.newScope();
         cf->d_impl->d_kind = Thing::Body;
         cf->d_impl->d_owner = cf;
 
@@ -1279,11 +1410,11 @@ private:
     }
     Symbol* addSym(const Asm::Token& t)
     {
-        Declaration* d = d_cf->d_impl->findDecl(Token::toId(t.d_val));
+        Declaration* d = d_cf->d_impl->findDecl(t.d_id);
         Symbol* sy = 0;
         if( d )
         {
-            sy = new Symbol();
+            sy = d_cf->d_arena.newSym();
             sy->d_loc = t.toLoc();
             d_cf->d_syms[t.d_sourcePath].append(sy);
             sy->d_decl = d;
@@ -1299,8 +1430,19 @@ private:
             if( s->d_tok.d_type == Asm::SynTree::R_directive)
                 directive(s);
             else if( s->d_tok.d_type == Asm::SynTree::R_statement)
-                collectSymbols(s);
+                statement(s);
+        }
+    }
+    void statement(Asm::SynTree* st)
+    {
+        bool isCall = false;
+        if( !st->d_children.isEmpty() && st->d_children.first()->d_tok.d_type == Asm::SynTree::R_mnemonic &&
+                !st->d_children.first()->d_children.isEmpty() )
+        {
+            const int op = st->d_children.first()->d_children.first()->d_tok.d_type;
+            isCall = op == Asm::Tok_JSR || op == Asm::Tok_BSR;
         }
+        collectSymbols(st, isCall);
     }
     void directive(Asm::SynTree* st)
     {
@@ -1323,7 +1465,11 @@ private:
                     if( sy && sy->d_decl)
                         sy->d_decl->d_kind = Thing::AsmDef;
                 }else
-                    addDecl(s->d_tok, type );
+                {
+                    Declaration* d = addDecl(s->d_tok, type );
+                    if( type == Thing::Proc || type == Thing::Func )
+                        d_proc = d;
+                }
             }else if( s->d_tok.d_type == Asm::SynTree::R_filename)
                 include(s);
             else if( s->d_tok.d_type == Asm::SynTree::R_expression)
@@ -1338,7 +1484,7 @@ private:
             if( s->d_tok.d_type == Asm::Tok_ident)
                 addDecl(s->d_tok, Thing::AsmMacro );
     }
-    void collectSymbols(Asm::SynTree* st)
+    void collectSymbols(Asm::SynTree* st, bool isCall = false)
     {
         foreach( Asm::SynTree* s, st->d_children )
         {
@@ -1349,12 +1495,19 @@ private:
             case Asm::SynTree::R_expression:
             case Asm::SynTree::R_term:
             case Asm::SynTree::R_factor:
-                collectSymbols(s);
+                collectSymbols(s, isCall);
                 break;
             case Asm::Tok_label:
             case Asm::Tok_ident:
             case Asm::Tok_macrocall:
-                addSym(s->d_tok);
+                {
+                    Symbol* sy = addSym(s->d_tok);
+                    if( isCall && sy && ( sy->d_decl->d_kind == Thing::Proc || sy->d_decl->d_kind == Thing::Func ||
+                                          sy->d_decl->d_kind == Thing::AsmRef ) )
+                        d_mdl->getCalls()->addCall(d_proc ? static_cast<Thing*>(d_proc) : d_cf,
+                                                   static_cast<Declaration*>(sy->d_decl),
+                                                   FilePos(sy->d_loc,s->d_tok.d_sourcePath));
+                }
                 break;
             }
         }
@@ -1406,16 +1559,16 @@ private:
     }
     Declaration* addDecl(const Asm::Token& t, int type )
     {
-        Declaration* d = new Declaration();
+        Declaration* d = d_cf->d_arena.newDecl();
         d->d_kind = type;
         d->d_name = t.d_val;
-        d->d_id = Token::toId(t.d_val);
+        d->d_id = t.d_id;
         d->d_loc.d_pos = t.toLoc();
         d->d_loc.d_filePath = t.d_sourcePath;
         d->d_owner = d_cf->d_impl;
         d_cf->d_impl->d_order.append(d);
 
-        Symbol* sy = new Symbol();
+        Symbol* sy = d_cf->d_arena.newSym();
         sy->d_loc = t.toLoc();
         d_cf->d_syms[t.d_sourcePath].append(sy);
         d->d_me = sy;
@@ -1426,25 +1579,87 @@ private:
     }
 };
 
-CodeModel::CodeModel(QObject *parent) : ItemModel(parent),d_sloc(0),d_errCount(0)
+CodeModel::CodeModel(QObject *parent) : ItemModel(parent),d_sloc(0),d_errCount(0),d_dedupFiles(0),d_dedupSloc(0),
+    d_incremental(false)
 {
     d_fs = new FileSystem(this);
 }
 
+static void prefetchOrder(FileSystem* fs, const FileSystem::File* f, const QHash<QString,QStringList>& includes,
+                          QSet<const FileSystem::File*>& seen, QStringList& order)
+{
+    // the order in which parseAndResolve reads the files, i.e. used units first; files already read
+    // by FileSystem::load are in the source store
+    if( seen.contains(f) )
+        return;
+    seen.insert(f);
+    foreach( const QByteArray& name, f->d_uses )
+    {
+        const FileSystem::File* u = fs->findModule(f->d_dir,name.toLower());
+        if( u && ( u->d_type == FileSystem::PascalProgram || u->d_type == FileSystem::PascalUnit ) )
+            prefetchOrder(fs, u, includes, seen, order);
+    }
+    if( !fs->getStore()->contains(f->d_realPath) )
+        order.append(f->d_realPath);
+    foreach( const QString& inc, includes.value(f->d_realPath) )
+    {
+        if( !fs->getStore()->contains(inc) )
+            order.append(inc);
+    }
+}
+
 bool CodeModel::load(const QString& rootDir)
 {
     beginResetModel();
     d_root = ModelItem();
+    QHash<QString,QStringList> includes; // of the previous load, to be prefetched with their unit
+    foreach( UnitFile* uf, d_map1 )
+    {
+        foreach( IncludeFile* inc, uf->d_includes )
+            if( inc->d_file )
+                includes[uf->d_file->d_realPath].append(inc->d_file->d_realPath);
+    }
     d_top.clear();
     d_globals.clear();
+    d_types.clear();
+    d_calls.clear();
+    d_classes.clear();
+    d_includes.clear();
     d_map1.clear();
     d_map2.clear();
     d_sloc = 0;
     d_errCount = 0;
+    d_dedupFiles = 0;
+    d_dedupSloc = 0;
     d_mutes.clear();
+    d_hashCount.clear();
     d_fs->load(rootDir);
     QList<ModelItem*> fileSlots;
     fillFolders(&d_root,&d_fs->getRoot(), &d_top, fileSlots);
+    foreach( ModelItem* s, fileSlots )
+        d_hashCount[static_cast<CodeFile*>(s->d_thing)->d_file->d_hash]++;
+    QStringList order;
+    QSet<const FileSystem::File*> seen;
+    foreach( ModelItem* s, fileSlots )
+    {
+        const CodeFile* cf = static_cast<CodeFile*>(s->d_thing);
+        if( cf->d_kind == Thing::Assembler && !d_fs->getStore()->contains(cf->d_file->d_realPath) )
+            order.append(cf->d_file->d_realPath);
+    }
+    foreach( ModelItem* s, fileSlots )
+    {
+        const CodeFile* cf = static_cast<CodeFile*>(s->d_thing);
+        if( cf->d_kind == Thing::Unit )
+            prefetchOrder(d_fs, cf->d_file, includes, seen, order);
+    }
+    Prefetcher::instance()->schedule(order);
+    QList<AsmFile*> asmFiles;
+    foreach( ModelItem* s, fileSlots )
+    {
+        if( s->d_thing->d_kind == Thing::Assembler )
+            asmFiles.append(static_cast<AsmFile*>(s->d_thing));
+    }
+    parseAsm(asmFiles);
     foreach( ModelItem* s, fileSlots )
     {
         Q_ASSERT( s->d_thing );
@@ -1458,7 +1673,7 @@ bool CodeModel::load(const QString& rootDir)
             AsmInclude* inc = f->d_includes[i];
             if( inc->d_file != 0 )
                 new ModelItem(s, f->d_includes[i]);
-            Symbol* sym = new Symbol();
+            Symbol* sym = f->d_arena.newSym();
             sym->d_decl = f->d_includes[i];
             sym->d_loc = RowCol(inc->d_row,inc->d_col);
             f->d_syms[f->d_file->d_realPath].append(sym);
@@ -1480,6 +1695,10 @@ bool CodeModel::load(const QString& rootDir)
                 new ModelItem(s, f->d_includes[i]);
         }
     }
+    Q_ASSERT( d_pasParses.isEmpty() && d_asmParses.isEmpty() && d_asmReady.isEmpty() );
+    Prefetcher::instance()->cancel(); // e.g. the files of deduplicated units
+    d_calls.freeze();
+    d_classes.freeze();
     endResetModel();
     return true;
 }
@@ -1684,6 +1903,11 @@ int ItemModel::rowCount(const QModelIndex& parent) const
 }
 
 
+static inline quint32 tokenHash(const Token& t)
+{
+    return qHash(t.d_val) * 31 + t.d_type;
+}
+
 class Lex
         #ifdef _USE_EBNF_STUDIO_PARSER_
         : public Scanner
@@ -1691,9 +1915,19 @@ class Lex
 {
 public:
     PpLexer lex;
+    UnitFile::Stream* d_stream; // if set, records the tokens delivered to the parser
+    QString d_path;
+    quint8 d_last; // type of the last delivered token
     Token next()
     {
-        return lex.nextToken();
+        Token t = lex.nextToken();
+        d_last = t.d_type;
+        if( d_stream )
+        {
+            d_stream->d_hash.append(tokenHash(t));
+            d_stream->d_pos.append(t.d_sourcePath == d_path ? t.toLoc().packed() : quint32(UnitFile::Stream::Foreign));
+        }
+        return t;
     }
 
     Token peek(int offset)
@@ -1701,9 +1935,123 @@ public:
         return lex.peekToken(offset);
     }
 
-    Lex(FileSystem*fs):lex(fs){}
+    Lex(FileSystem*fs):lex(fs),d_stream(0),d_last(Tok_Invalid){}
 };
 
+class TokenList : public Scanner
+{
+public:
+    QList<Token> d_toks;
+    int d_pos;
+    Token next()
+    {
+        return d_pos < d_toks.size() ? d_toks[d_pos++] : Token(Tok_Eof);
+    }
+    Token peek(int offset)
+    {
+        const int i = d_pos + offset - 1;
+        return i < d_toks.size() ? d_toks[i] : Token(Tok_Eof);
+    }
+    TokenList(const QList<Token>& toks):d_toks(toks),d_pos(0){}
+};
+
+class RoutineParser : public PascalParser // the same parser as CodeModel::load, so the trees don't differ
+{
+public:
+    RoutineParser(Scanner* s):PascalParser(s){}
+    void run(int kind)
+    {
+#ifdef LISA_TABLE_PARSER
+        RunRule(kind == Thing::Func ? SynTree::R_function_declaration : SynTree::R_procedure_declaration);
+#else
+        next();
+        if( kind == Thing::Func )
+            function_declaration(&root);
+        else
+            procedure_declaration(&root);
+#endif
+        if( la.d_type != Tok_Eof )
+            errors << Error("unexpected tokens after routine", la.d_lineNr, la.d_colNr, la.d_sourcePath);
+    }
+};
+
+struct CodeModel::PasParse
+{
+    const FileSystem::File* d_file; // the file which was actually lexed and parsed
+    QString d_path; // the real path the tokens of d_root currently refer to
+    SynTree d_root;
+    QList<PpLexer::Include> d_includes;
+    QList<Parser::Error> d_errors;
+    QHash<QString,Ranges> d_mutes;
+    quint32 d_sloc;
+    UnitFile::Stream d_stream;
+    PasParse():d_file(0),d_sloc(0){}
+};
+
+struct CodeModel::AsmParse
+{
+    const FileSystem::File* d_file;
+    QString d_path;
+    Asm::SynTree d_root;
+    QList<Asm::PpLexer::Include> d_includes;
+    QList<Asm::Parser::Error> d_errors;
+    quint32 d_sloc;
+    AsmParse():d_file(0),d_sloc(0){}
+};
+
+class CodeModel::AsmTask : public QRunnable
+{
+public:
+    AsmTask(FileSystem* fs, AsmParse* pp, QThreadPool* pool = 0):d_fs(fs),d_pp(pp),d_pool(pool){}
+    void run()
+    {
+        // the lexer and parser only share the file system and the source store, which are thread safe
+        Asm::ChunkParser p(d_fs, d_pool); // large files are split on the same pool
+        p.RunParser(d_pp->d_path);
+        d_pp->d_root.d_tok = p.d_root.d_tok;
+        d_pp->d_root.d_children = p.d_root.d_children;
+        p.d_root.d_children.clear();
+        d_pp->d_errors = p.errors;
+        d_pp->d_includes = p.getIncludes();
+        d_pp->d_sloc = p.getSloc();
+    }
+private:
+    FileSystem* d_fs;
+    AsmParse* d_pp;
+    QThreadPool* d_pool;
+};
+
+static inline const QString& remapPath(const QString& path, const QString& from, const QString& to)
+{
+    return path == from ? to : path;
+}
+
+template<class T>
+static void remapTree(T* st, const QString& from, const QString& to)
+{
+    if( st->d_tok.d_sourcePath == from )
+        st->d_tok.d_sourcePath = to;
+    foreach( T* sub, st->d_children )
+        remapTree(sub, from, to);
+}
+
+template<class T>
+static bool sameIncludeContext(FileSystem* fs, const QList<T>& includes, const FileSystem::File* parsed,
+                               const FileSystem::File* other)
+{
+    // only the directives of the module itself are looked up relative to its directory;
+    // nested includes are resolved relative to the (same) include files and thus need no check
+    foreach( const T& inc, includes )
+    {
+        if( inc.d_sourcePath != parsed->d_realPath )
+            continue;
+        const FileSystem::File* f = inc.d_name.isEmpty() ? 0 : fs->findFile(other->d_dir, inc.d_dir, inc.d_name);
+        if( f != inc.d_inc )
+            return false;
+    }
+    return true;
+}
+
 void CodeModel::parseAndResolve(UnitFile* unit)
 {
     if( unit->d_file->d_parsed )
@@ -1729,100 +2077,360 @@ void CodeModel::parseAndResolve(UnitFile* unit)
     }
 
     const_cast<FileSystem::File*>(unit->d_file)->d_parsed = true;
-    Lex lex(d_fs);
-    lex.lex.reset(unit->d_file->d_realPath);
+    const QString& path = unit->d_file->d_realPath;
+    const QByteArray& hash = unit->d_file->d_hash;
+    const int remaining = --d_hashCount[hash]; // number of identical files still to come
+
+    PasParse local;
+    PasParse* pp = d_pasParses.value(hash);
+    if( pp && sameIncludeContext(d_fs, pp->d_includes, pp->d_file, unit->d_file) )
+    {
+        remapTree(&pp->d_root, pp->d_path, path);
+        pp->d_path = path;
+        d_dedupFiles++;
+        d_dedupSloc += pp->d_sloc;
+    }else
+    {
+        pp = &local;
+        if( remaining > 0 && !d_pasParses.contains(hash) )
+        {
+            pp = new PasParse();
+            d_pasParses[hash] = pp;
+        }
+        pp->d_file = unit->d_file;
+        pp->d_path = path;
+        Lex lex(d_fs);
+        if( d_incremental )
+        {
+            lex.lex.setCheckpointInterval(UnitFile::Stream::CheckpointLines);
+            lex.d_stream = &pp->d_stream;
+            lex.d_path = path;
+        }
+        lex.lex.reset(path);
 #ifdef _USE_EBNF_STUDIO_PARSER_
-    Parser p(&lex);
+        PascalParser p(&lex);
+        SynTree& root = p.root;
 #else
-    Parser p(&lex.lex);
+        Parser p(&lex.lex);
+        SynTree& root = p.d_root;
 #endif
-    p.RunParser();
-    const int off = d_fs->getRootPath().size();
-    if( !p.errors.isEmpty() )
-    {
-        foreach( const Parser::Error& e, p.errors )
+        p.RunParser();
+        while( lex.d_stream && lex.d_last != Tok_Eof )
+            lex.next(); // the parser might have given up early
+        pp->d_root.d_tok = root.d_tok;
+        pp->d_root.d_children = root.d_children; // take ownership
+        root.d_children.clear();
+        pp->d_errors = p.errors;
+        pp->d_includes = lex.lex.getIncludes();
+        pp->d_mutes = lex.lex.getMutes();
+        pp->d_sloc = lex.lex.getSloc();
+        pp->d_stream.d_sloc = pp->d_sloc;
+        if( lex.d_stream )
         {
-            const FileSystem::File* f = d_fs->findFile(e.path);
-            const QString line = tr("%1:%2:%3: %4").arg( f ? f->getVirtualPath() : e.path.mid(off) ).arg(e.row)
-                    .arg(e.col).arg(e.msg);
-            qCritical() << line.toUtf8().constData();
-            d_errCount++;
+            pp->d_stream.d_checkpoints = lex.lex.getCheckpoints();
+            pp->d_stream.d_source = d_fs->getStore()->get(path);
         }
+    }
 
+    const QString& from = pp->d_file->d_realPath;
+    const int off = d_fs->getRootPath().size();
+    foreach( const Parser::Error& e, pp->d_errors )
+    {
+        const QString& epath = remapPath(e.path,from,path);
+        const FileSystem::File* f = d_fs->findFile(epath);
+        const QString line = tr("%1:%2:%3: %4").arg( f ? f->getVirtualPath() : epath.mid(off) ).arg(e.row)
+                .arg(e.col).arg(e.msg);
+        qCritical() << line.toUtf8().constData();
+        d_errCount++;
     }
-    foreach( const PpLexer::Include& f, lex.lex.getIncludes() )
+    foreach( const PpLexer::Include& f, pp->d_includes )
     {
         IncludeFile* inc = new IncludeFile();
         inc->d_file = f.d_inc;
         inc->d_len = f.d_len;
         inc->d_unit = unit;
         inc->d_folder = unit->d_folder;
-        Symbol* sym = new Symbol();
+        Symbol* sym = unit->d_arena.newSym();
         sym->d_decl = inc;
         sym->d_loc = f.d_loc;
-        unit->d_syms[f.d_sourcePath].append(sym);
+        unit->d_syms[remapPath(f.d_sourcePath,from,path)].append(sym);
         if( f.d_inc )
+        {
             d_map2[f.d_inc->d_realPath] = inc;
+            d_includes.addInclude(unit, inc, FilePos(f.d_loc,remapPath(f.d_sourcePath,from,path)));
+        }
         unit->d_includes.append(inc);
     }
-    d_sloc += lex.lex.getSloc();
-    for( QHash<QString,Ranges>::const_iterator i = lex.lex.getMutes().begin(); i != lex.lex.getMutes().end(); ++i )
-        d_mutes.insert(i.key(),i.value());
+    d_sloc += pp->d_sloc;
+    for( QHash<QString,Ranges>::const_iterator i = pp->d_mutes.begin(); i != pp->d_mutes.end(); ++i )
+        d_mutes.insert(remapPath(i.key(),from,path),i.value());
 
+    if( d_incremental )
+        unit->d_stream = new UnitFile::Stream(pp->d_stream); // the visitor adds the routines
     PascalModelVisitor v(this);
-#ifdef _USE_EBNF_STUDIO_PARSER_
-    v.visit(unit,&p.root); // visit takes ~8% more time than just parsing
-#else
-    v.visit(unit,&p.d_root);
-#endif
+    v.visit(unit,&pp->d_root); // visit takes ~8% more time than just parsing
+
+    if( remaining == 0 && d_pasParses.contains(hash) )
+        delete d_pasParses.take(hash);
 
     QCoreApplication::processEvents();
 }
 
+static void moveDecls(Scope* scope, const QString& path, const RowCol& after, int rows, QSet<Scope*>& done)
+{
+    if( scope == 0 || done.contains(scope) )
+        return;
+    done.insert(scope);
+    foreach( Declaration* d, scope->d_order )
+    {
+        if( d->d_loc.d_filePath == path && after < d->d_loc.d_pos )
+            d->d_loc.d_pos.d_row += rows;
+        moveDecls(d->d_body, path, after, rows, done);
+        if( d->d_type )
+            moveDecls(d->d_type->d_members, path, after, rows, done);
+    }
+}
+
+bool CodeModel::reparseRoutine(Declaration* routine)
+{
+    if( routine == 0 || routine->d_owner == 0 ||
+            ( routine->d_kind != Thing::Proc && routine->d_kind != Thing::Func ) )
+        return false;
+    UnitFile* unit = getUnitFile(routine->d_loc.d_filePath);
+    if( unit == 0 || unit->d_stream == 0 || !unit->d_stream->d_routines.contains(routine) )
+        return false;
+    UnitFile::Stream* old = unit->d_stream;
+    const Range span = old->d_routines.value(routine);
+    const QString& path = unit->d_file->d_realPath;
+
+    // the old routine are the tokens [from,to]; the closing semicolon is not in the syntax tree
+    const int from = old->d_pos.indexOf(span.first.packed());
+    if( from < 0 )
+        return false;
+    const int to = old->d_pos.indexOf(span.second.packed(), from) + 1;
+    if( to <= from || to >= old->d_hash.size() )
+        return false;
+
+    d_fs->getStore()->invalidate(path); // the file was edited since it was read
+    const QByteArray source = d_fs->getStore()->get(path);
+    Lex lex(d_fs);
+    lex.lex.setCheckpointInterval(UnitFile::Stream::CheckpointLines);
+    lex.lex.reset(path);
+
+    // lexing resumes at the last checkpoint before the routine if the file is unchanged up to there;
+    // the tokens before it are the ones of the old stream
+    int start = 0;
+    lex.lex.setCheckpoints(old->d_checkpoints);
+    const int cp = lex.lex.findCheckpoint(span.first.d_row);
+    const qint64 off = cp >= 0 ? old->d_checkpoints[cp].d_lex.d_offset : 0;
+    if( cp >= 0 && int(lex.lex.getCheckpointToken(cp)) <= from && off <= source.size() && off <= old->d_source.size() &&
+            ::memcmp(source.constData(), old->d_source.constData(), off) == 0 && lex.lex.resume(cp) )
+        start = lex.lex.getCheckpointToken(cp);
+    else
+        lex.lex.reset(path); // lexes the whole file
+    UnitFile::Stream cur;
+    cur.d_hash = old->d_hash.mid(0, start);
+    cur.d_pos = old->d_pos.mid(0, start);
+    lex.d_stream = &cur;
+    lex.d_path = path;
+    QList<Token> toks; // starting with token number start
+    Token t;
+    do
+    {
+        t = lex.next();
+        toks.append(t);
+    }while( t.d_type != Tok_Eof );
+
+    // the new routine are the tokens [from,last], the remainder must be the same as before
+    const int tail = old->d_hash.size() - to - 1;
+    const int last = cur.d_hash.size() - tail - 1;
+    if( last <= from || toks[last - start].d_type != Tok_Semi || cur.d_hash[last] != old->d_hash[to] )
+        return false;
+    int heading = from;
+    int level = 0;
+    while( heading < last && ( toks[heading - start].d_type != Tok_Semi || level != 0 ) )
+    {
+        if( toks[heading - start].d_type == Tok_Lpar )
+            level++;
+        else if( toks[heading - start].d_type == Tok_Rpar )
+            level--;
+        heading++;
+    }
+    if( heading >= to )
+        return false;
+    for( int i = start; i <= heading; i++ )
+    {
+        if( cur.d_hash[i] != old->d_hash[i] || cur.d_pos[i] != old->d_pos[i] )
+            return false; // the change is not confined to the body
+    }
+    for( int i = from; i <= to; i++ )
+        if( old->d_pos[i] == UnitFile::Stream::Foreign )
+            return false;
+    for( int i = from; i <= last; i++ )
+        if( cur.d_pos[i] == UnitFile::Stream::Foreign )
+            return false;
+    const int rows = int(cur.d_pos[last] >> RowCol::COL_BIT_LEN) - int(old->d_pos[to] >> RowCol::COL_BIT_LEN);
+    const quint32 shift = quint32(rows) << RowCol::COL_BIT_LEN;
+    for( int i = 1; i <= tail; i++ )
+    {
+        const quint32 pos = old->d_pos[to + i];
+        if( cur.d_hash[last + i] != old->d_hash[to + i] ||
+                cur.d_pos[last + i] != ( pos == UnitFile::Stream::Foreign ? pos : pos + shift ) )
+            return false;
+    }
+
+    TokenList list(toks.mid(from - start, last - from + 1));
+    RoutineParser p(&list);
+    p.run(routine->d_kind);
+    if( !p.errors.isEmpty() || p.root.d_children.isEmpty() ||
+            !PascalModelVisitor::hasHeading(p.root.d_children.first()) )
+        return false; // let a full parse report the errors
+
+    // from here on the routine is replaced; nothing must fail anymore
+    const RowCol first = span.first;
+    const RowCol end( old->d_pos[to] >> RowCol::COL_BIT_LEN, old->d_pos[to] & ( ( 1 << RowCol::COL_BIT_LEN ) - 1 ) );
+    UnitFile::SymList& syms = unit->d_syms[path];
+    UnitFile::SymList keep;
+    foreach( Symbol* sy, syms )
+    {
+        if( !( sy->d_loc < first ) && !( end < sy->d_loc ) )
+        {
+            if( sy->d_decl && sy->d_decl->isDeclaration() )
+                static_cast<Declaration*>(sy->d_decl)->d_refs[path].removeOne(sy);
+            continue; // the symbol stays in the arena until the next load
+        }
+        if( end < sy->d_loc )
+            sy->d_loc.d_row += rows;
+        keep.append(sy);
+    }
+    syms = keep;
+    QSet<Scope*> done;
+    moveDecls(unit->d_intf, path, end, rows, done);
+    moveDecls(unit->d_impl, path, end, rows, done);
+    QHash<const Declaration*,Range>::iterator i = old->d_routines.begin();
+    while( i != old->d_routines.end() )
+    {
+        if( i.key() == routine || ( !( i.value().first < first ) && !( end < i.value().first ) ) )
+        {
+            i = old->d_routines.erase(i); // the nested ones are recreated
+            continue;
+        }
+        if( end < i.value().first )
+            i.value().first.d_row += rows;
+        if( end < i.value().second )
+            i.value().second.d_row += rows;
+        ++i;
+    }
+    d_calls.thaw();
+    d_calls.removeCalls(path, first, end);
+    d_calls.moveCalls(path, end, rows);
+    d_includes.moveIncludes(path, end, rows);
+
+    old->d_hash = cur.d_hash;
+    old->d_pos = cur.d_pos;
+    old->d_checkpoints = lex.lex.getCheckpoints();
+    old->d_source = source;
+    d_sloc += lex.lex.getSloc() - old->d_sloc;
+    old->d_sloc = lex.lex.getSloc();
+    d_mutes.insert(path, lex.lex.getMutes().value(path)); // the includes are unchanged
+
+    PascalModelVisitor v(this);
+    v.reparse(unit, routine, p.root.d_children.first());
+    d_calls.freeze();
+    return true;
+}
+
 void CodeModel::parseAndResolve(AsmFile* unit)
 {
     const_cast<FileSystem::File*>(unit->d_file)->d_parsed = true;
-    Asm::PpLexer lex(d_fs);
-    lex.reset(unit->d_file->d_realPath);
-    Asm::Parser p(&lex);
-    p.RunParser();
-    const int off = d_fs->getRootPath().size();
-    if( !p.errors.isEmpty() )
+    const QString& path = unit->d_file->d_realPath;
+    const QByteArray& hash = unit->d_file->d_hash;
+    const int remaining = --d_hashCount[hash];
+
+    QScopedPointer<AsmParse> local;
+    AsmParse* pp = d_asmParses.value(hash);
+    if( pp && sameIncludeContext(d_fs, pp->d_includes, pp->d_file, unit->d_file) )
+    {
+        remapTree(&pp->d_root, pp->d_path, path);
+        pp->d_path = path;
+        d_dedupFiles++;
+        d_dedupSloc += pp->d_sloc;
+    }else
     {
-        foreach( const Asm::Parser::Error& e, p.errors )
+        pp = d_asmReady.take(unit->d_file);
+        if( pp == 0 )
         {
-            const FileSystem::File* f = d_fs->findFile(e.path);
-            const QString line = tr("%1:%2:%3: %4").arg( f ? f->getVirtualPath() : e.path.mid(off) ).arg(e.row)
-                    .arg(e.col).arg(e.msg);
-            qCritical() << line.toUtf8().constData();
-            d_errCount++;
+            pp = new AsmParse();
+            pp->d_file = unit->d_file;
+            pp->d_path = path;
+            AsmTask(d_fs, pp).run();
         }
+        if( remaining > 0 && !d_asmParses.contains(hash) )
+            d_asmParses[hash] = pp;
+        else
+            local.reset(pp);
+    }
 
+    const QString& from = pp->d_file->d_realPath;
+    const int off = d_fs->getRootPath().size();
+    foreach( const Asm::Parser::Error& e, pp->d_errors )
+    {
+        const QString& epath = remapPath(e.path,from,path);
+        const FileSystem::File* f = d_fs->findFile(epath);
+        const QString line = tr("%1:%2:%3: %4").arg( f ? f->getVirtualPath() : epath.mid(off) ).arg(e.row)
+                .arg(e.col).arg(e.msg);
+        qCritical() << line.toUtf8().constData();
+        d_errCount++;
     }
-    foreach( const Asm::PpLexer::Include& f, lex.getIncludes() )
+    foreach( const Asm::PpLexer::Include& f, pp->d_includes )
     {
         AsmInclude* inc = new AsmInclude();
         inc->d_file = f.d_inc;
         inc->d_len = f.d_len;
         inc->d_unit = unit;
         inc->d_folder = unit->d_folder;
-        Symbol* sym = new Symbol();
+        Symbol* sym = unit->d_arena.newSym();
         sym->d_decl = inc;
         sym->d_loc = f.d_loc;
-        unit->d_syms[f.d_sourcePath].append(sym);
+        unit->d_syms[remapPath(f.d_sourcePath,from,path)].append(sym);
         if( f.d_inc )
+        {
             d_map2[f.d_inc->d_realPath] = inc;
+            d_includes.addInclude(unit, inc, FilePos(f.d_loc,remapPath(f.d_sourcePath,from,path)));
+        }
         unit->d_includes.append(inc);
     }
-    d_sloc += lex.getSloc();
+    d_sloc += pp->d_sloc;
 
     AsmModelVisitor v(this);
-    v.visit(unit,&p.d_root);
+    v.visit(unit,&pp->d_root);
 
+    if( remaining == 0 && d_asmParses.contains(hash) )
+        delete d_asmParses.take(hash);
 
     QCoreApplication::processEvents();
 }
 
+void CodeModel::parseAsm(const QList<AsmFile*>& files)
+{
+    // lexes and parses the first file of each content hash in parallel; parseAndResolve takes the
+    // results in the order of the files, so resolving and deduplication don't depend on the threads
+    QSet<QByteArray> hashes;
+    QThreadPool pool;
+    foreach( AsmFile* f, files )
+    {
+        if( hashes.contains(f->d_file->d_hash) )
+            continue;
+        hashes.insert(f->d_file->d_hash);
+        AsmParse* pp = new AsmParse();
+        pp->d_file = f->d_file;
+        pp->d_path = f->d_file->d_realPath;
+        d_asmReady.insert(f->d_file, pp);
+        pool.start(new AsmTask(d_fs, pp, &pool));
+    }
+    pool.waitForDone();
+}
+
 QModelIndex ItemModel::findThing(const ModelItem* slot, const Thing* nt) const
 {
     for( int i = 0; i < slot->d_children.size(); i++ )
@@ -1882,77 +2490,19 @@ void CodeModel::fillFolders(ModelItem* root, const FileSystem::Dir* super, CodeF
     std::sort( root->d_children.begin(), root->d_children.end(), ModelItem::lessThan );
 }
 
-QString CodeFile::getName() const
-{
-    return d_file->d_name;
-}
 
 QByteArrayList UnitFile::findUses() const
 {
-    QByteArrayList res;
     if( d_file == 0 || !(d_file->d_type == FileSystem::PascalProgram ||
                          d_file->d_type == FileSystem::PascalUnit) )
-        return res;
-    QFile f(d_file->d_realPath);
-    f.open(QIODevice::ReadOnly);
-    Lexer lex;
-    lex.setStream(&f);
-    Token t = lex.nextToken();
-    while( t.isValid() )
-    {
-        switch( t.d_type )
-        {
-        case Tok_uses:
-            t = lex.nextToken();
-            while( t.isValid() && t.d_type != Tok_Semi )
-            {
-                if( t.d_type == Tok_Comma )
-                {
-                    t = lex.nextToken();
-                    continue;
-                }
-                if( t.d_type == Tok_identifier )
-                {
-                    const QByteArray id = t.d_val;
-                    t = lex.nextToken();
-                    if( t.d_type == Tok_Slash )
-                    {
-                        t = lex.nextToken();
-                        if( t.d_type == Tok_identifier ) // just to make sure
-                        {
-                            res.append( t.d_val );
-                            t = lex.nextToken();
-                        }
-                    }else
-                        res.append(id);
-                }else
-                    t = lex.nextToken();
-            }
-            return res;
-        case Tok_label:
-        case Tok_var:
-        case Tok_const:
-        case Tok_type:
-        case Tok_procedure:
-        case Tok_function:
-        case Tok_implementation:
-            return res;
-        }
-        t = lex.nextToken();
-    }
-    return res;
+        return QByteArrayList();
+    return d_file->d_uses; // see FileSystem::scanHeader
 }
 
 UnitFile::~UnitFile()
 {
-    if( d_impl )
-        delete d_impl;
-    if( d_intf )
-        delete d_intf;
-    QHash<QString,SymList>::const_iterator j;
-    for( j = d_syms.begin(); j != d_syms.end(); ++j )
-        for( int i = 0; i < j.value().size(); i++ )
-            delete j.value()[i];
+    if( d_stream )
+        delete d_stream;
     for( int i = 0; i < d_includes.size(); i++ )
         delete d_includes[i];
 }
@@ -2013,22 +2563,6 @@ Declaration*Scope::findDecl(const char* id, bool withImports) const
     return 0;
 }
 
-void Scope::clear()
-{
-    for( int i = 0; i < d_order.size(); i++ )
-        delete d_order[i];
-    d_order.clear();
-}
-
-Scope::~Scope()
-{
-    clear();
-}
-
-QString Declaration::getName() const
-{
-    return d_name;
-}
 
 UnitFile*Declaration::getUnitFile() const
 {
@@ -2036,17 +2570,6 @@ UnitFile*Declaration::getUnitFile() const
     return d_owner->getUnitFile();
 }
 
-Declaration::~Declaration()
-{
-    if( d_body )
-        delete d_body;
-}
-
-QString CodeFolder::getName() const
-{
-    return d_dir->d_name;
-}
-
 void CodeFolder::clear()
 {
     for( int i = 0; i < d_subs.size(); i++ )
@@ -2056,22 +2579,66 @@ void CodeFolder::clear()
     }
     d_subs.clear();
     for( int i = 0; i < d_files.size(); i++ )
-        delete d_files[i];
+        CodeFile::destroy(d_files[i]);
     d_files.clear();
 }
 
-FilePos IncludeFile::getLoc() const
+FilePos IncludeFile::getIncludeLoc() const
 {
     if( d_file == 0 )
         return FilePos();
     return FilePos( RowCol(1,1), d_file->d_realPath );
 }
 
+FilePos Thing::getLoc() const
+{
+    if( isDeclaration() )
+        return static_cast<const Declaration*>(this)->d_loc;
+    switch( d_kind )
+    {
+    case Include:
+        return static_cast<const IncludeFile*>(this)->getIncludeLoc();
+    case AsmIncl:
+        return static_cast<const AsmInclude*>(this)->getIncludeLoc();
+    default:
+        return FilePos();
+    }
+}
+
+quint16 Thing::getLen() const
+{
+    if( isDeclaration() )
+        return static_cast<const Declaration*>(this)->d_name.size();
+    switch( d_kind )
+    {
+    case Include:
+        return static_cast<const IncludeFile*>(this)->d_len;
+    case AsmIncl:
+        return static_cast<const AsmInclude*>(this)->d_len;
+    default:
+        return 0;
+    }
+}
+
 QString Thing::getName() const
 {
+    if( isDeclaration() )
+        return static_cast<const Declaration*>(this)->d_name;
+    if( isCodeFile() )
+        return static_cast<const CodeFile*>(this)->d_file->d_name;
+    if( d_kind == Folder )
+        return static_cast<const CodeFolder*>(this)->d_dir->d_name;
     return QString();
 }
 
+const FileSystem::File*Thing::getFile() const
+{
+    if( isCodeFile() )
+        return static_cast<const CodeFile*>(this)->d_file;
+    else
+        return 0;
+}
+
 const char*Thing::typeName() const
 {
     switch( d_kind )
@@ -2099,10 +2666,6 @@ const char*Thing::typeName() const
     }
 }
 
-Thing::~Thing()
-{
-}
-
 UnitFile*CodeFile::toUnit()
 {
     if( d_kind == Unit )
@@ -2135,16 +2698,411 @@ AsmInclude*CodeFile::toAsmInclude()
         return 0;
 }
 
-CodeFile::~CodeFile()
+void CodeFile::destroy(CodeFile* f)
+{
+    // there are no virtual destructors
+    switch( f->d_kind )
+    {
+    case Unit:
+        delete static_cast<UnitFile*>(f);
+        break;
+    case Assembler:
+        delete static_cast<AsmFile*>(f);
+        break;
+    case Include:
+        delete static_cast<IncludeFile*>(f);
+        break;
+    case AsmIncl:
+        delete static_cast<AsmInclude*>(f);
+        break;
+    default:
+        delete f;
+        break;
+    }
+}
+
+Type* TypeArena::create(quint8 kind, Type* base)
 {
+    Type* t = new Type();
+    t->d_kind = kind;
+    t->d_type = base;
+    d_types.append(t);
+    d_requests++;
+    return t;
 }
 
-Type::~Type()
+Type* TypeArena::shared(quint8 kind, Type* base)
 {
-    if( d_members )
-        delete d_members;
+    Q_ASSERT( kind == Type::Pointer || kind == Type::Array );
+    Type*& t = d_shared[qMakePair(kind,base)];
+    if( t == 0 )
+        t = create(kind,base);
+    else
+        d_requests++;
+    return t;
 }
 
+void TypeArena::clear()
+{
+    for( int i = 0; i < d_types.size(); i++ )
+        delete d_types[i];
+    d_types.clear();
+    d_shared.clear();
+    d_requests = 0;
+}
+
+void CallGraph::addCall(Thing* caller, Declaration* callee, const FilePos& loc)
+{
+    Q_ASSERT( !d_frozen && caller && callee );
+    Call c;
+    c.d_caller = caller;
+    c.d_callee = callee;
+    c.d_loc = loc;
+    d_calls.append(c);
+}
+
+static void groupCalls(const QVector<quint32>& node, int nodeCount, QVector<quint32>& off, QVector<quint32>& idx)
+{
+    // counting sort by node; keeps the calls of a node in the order they were found
+    off.fill(0, nodeCount + 1);
+    for( int i = 0; i < node.size(); i++ )
+        off[node[i]+1]++;
+    for( int n = 0; n < nodeCount; n++ )
+        off[n+1] += off[n];
+    idx.resize(node.size());
+    QVector<quint32> pos = off;
+    for( int i = 0; i < node.size(); i++ )
+        idx[pos[node[i]]++] = i;
+}
+
+void CallGraph::freeze()
+{
+    d_nodes.clear();
+    QVector<quint32> from(d_calls.size()), to(d_calls.size());
+    for( int i = 0; i < d_calls.size(); i++ )
+    {
+        QHash<const Thing*,quint32>::const_iterator n = d_nodes.find(d_calls[i].d_caller);
+        if( n == d_nodes.end() )
+            n = d_nodes.insert(d_calls[i].d_caller, d_nodes.size());
+        from[i] = n.value();
+        n = d_nodes.find(d_calls[i].d_callee);
+        if( n == d_nodes.end() )
+            n = d_nodes.insert(d_calls[i].d_callee, d_nodes.size());
+        to[i] = n.value();
+    }
+    groupCalls(from, d_nodes.size(), d_outOff, d_out);
+    groupCalls(to, d_nodes.size(), d_inOff, d_in);
+    d_frozen = true;
+}
+
+void CallGraph::thaw()
+{
+    d_nodes.clear();
+    d_outOff.clear();
+    d_out.clear();
+    d_inOff.clear();
+    d_in.clear();
+    d_frozen = false;
+}
+
+void CallGraph::removeCalls(const QString& path, const RowCol& from, const RowCol& to)
+{
+    Q_ASSERT( !d_frozen );
+    int n = 0;
+    for( int i = 0; i < d_calls.size(); i++ )
+    {
+        const FilePos& loc = d_calls[i].d_loc;
+        if( loc.d_filePath == path && !( loc.d_pos < from ) && !( to < loc.d_pos ) )
+            continue;
+        d_calls[n++] = d_calls[i];
+    }
+    d_calls.resize(n);
+}
+
+void CallGraph::moveCalls(const QString& path, const RowCol& after, int rows)
+{
+    for( int i = 0; i < d_calls.size(); i++ )
+    {
+        FilePos& loc = d_calls[i].d_loc;
+        if( loc.d_filePath == path && after < loc.d_pos )
+            loc.d_pos.d_row += rows;
+    }
+}
+
+void CallGraph::replace(const Declaration* old, Declaration* by)
+{
+    Q_ASSERT( !d_frozen );
+    for( int i = 0; i < d_calls.size(); i++ )
+    {
+        if( d_calls[i].d_caller == old )
+            d_calls[i].d_caller = by;
+        if( d_calls[i].d_callee == old )
+            d_calls[i].d_callee = by;
+    }
+}
+
+void CallGraph::clear()
+{
+    d_calls.clear();
+    d_nodes.clear();
+    d_outOff.clear();
+    d_out.clear();
+    d_inOff.clear();
+    d_in.clear();
+    d_frozen = false;
+}
+
+CallGraph::Range CallGraph::getCallees(const Thing* caller) const
+{
+    return range(d_outOff, d_out, caller);
+}
+
+CallGraph::Range CallGraph::getCallers(const Thing* callee) const
+{
+    return range(d_inOff, d_in, callee);
+}
+
+CallGraph::Range CallGraph::range(const QVector<quint32>& off, const QVector<quint32>& idx, const Thing* t) const
+{
+    QHash<const Thing*,quint32>::const_iterator n = d_nodes.find(t);
+    if( !d_frozen || n == d_nodes.end() )
+        return Range(0,0);
+    const quint32* base = idx.constData();
+    return Range(base + off[n.value()], base + off[n.value()+1]);
+}
+
+void ClassHierarchy::addClass(Declaration* cls)
+{
+    Q_ASSERT( !d_frozen && cls && cls->d_type && cls->d_type->d_kind == Type::Class );
+    if( d_byType.contains(cls->d_type) )
+        return; // an alias of a known class
+    d_byType.insert(cls->d_type, d_nodes.size());
+    Node n;
+    n.d_cls = cls;
+    d_nodes.append(n);
+}
+
+void ClassHierarchy::number(int n, quint32& pre)
+{
+    d_nodes[n].d_pre = pre++;
+    foreach( int sub, d_nodes[n].d_subs )
+        number(sub, pre);
+    d_nodes[n].d_last = pre - 1;
+}
+
+void ClassHierarchy::freeze()
+{
+    QList<int> roots;
+    for( int i = 0; i < d_nodes.size(); i++ )
+    {
+        const Type* super = d_nodes[i].d_cls->d_type->d_type;
+        const int s = super ? d_byType.value(super,-1) : -1;
+        d_nodes[i].d_super = s;
+        if( s >= 0 )
+            d_nodes[s].d_subs.append(i);
+        else
+            roots.append(i);
+    }
+    quint32 pre = 0;
+    foreach( int r, roots )
+        number(r, pre);
+    QVector<int> order(d_nodes.size());
+    for( int i = 0; i < d_nodes.size(); i++ )
+        order[d_nodes[i].d_pre] = i;
+
+    // visit the classes in pre-order so that the methods of the superclasses are already known
+    QVector< QHash<const char*,quint32> > own(d_nodes.size()); // node -> method name -> index in methods
+    QVector<Method> methods;
+    QVector<quint32> chain; // method index -> chain number
+    quint32 chains = 0;
+    foreach( int n, order )
+    {
+        const Node& cls = d_nodes[n];
+        foreach( Declaration* d, cls.d_cls->d_type->d_members->d_order )
+        {
+            if( d->d_kind != Thing::Func && d->d_kind != Thing::Proc )
+                continue;
+            Method m;
+            m.d_meth = d;
+            m.d_overridden = 0;
+            m.d_pre = cls.d_pre;
+            m.d_last = cls.d_last;
+            m.d_from = m.d_to = 0;
+            int super = cls.d_super;
+            while( super >= 0 && m.d_overridden == 0 )
+            {
+                QHash<const char*,quint32>::const_iterator i = own[super].find(d->d_id);
+                if( i != own[super].end() )
+                {
+                    m.d_overridden = methods[i.value()].d_meth;
+                    chain.append(chain[i.value()]);
+                }
+                super = d_nodes[super].d_super;
+            }
+            if( m.d_overridden == 0 )
+                chain.append(chains++);
+            own[n].insert(d->d_id, methods.size());
+            methods.append(m);
+        }
+    }
+
+    // group the methods by chain, keeping the pre-order within each chain
+    QVector< QPair<quint32,quint32> > sorted(methods.size()); // chain, index
+    for( int i = 0; i < methods.size(); i++ )
+        sorted[i] = qMakePair(chain[i], quint32(i));
+    std::sort(sorted.begin(), sorted.end());
+    d_methods.resize(methods.size());
+    d_byMethod.clear();
+    int from = 0;
+    for( int i = 0; i < sorted.size(); i++ )
+    {
+        if( i > 0 && sorted[i].first != sorted[i-1].first )
+            from = i;
+        d_methods[i] = methods[sorted[i].second];
+        d_methods[i].d_from = from;
+        d_byMethod.insert(d_methods[i].d_meth, i);
+    }
+    for( int i = d_methods.size() - 1, to = d_methods.size(); i >= 0; i-- )
+    {
+        d_methods[i].d_to = to;
+        if( d_methods[i].d_from == quint32(i) )
+            to = i;
+    }
+    d_frozen = true;
+}
+
+void ClassHierarchy::clear()
+{
+    d_nodes.clear();
+    d_byType.clear();
+    d_methods.clear();
+    d_byMethod.clear();
+    d_frozen = false;
+}
+
+int ClassHierarchy::node(const Declaration* cls) const
+{
+    if( cls == 0 || cls->d_type == 0 )
+        return -1;
+    return d_byType.value(cls->d_type,-1);
+}
+
+Declaration* ClassHierarchy::getClass(const Type* t) const
+{
+    const int n = d_byType.value(t,-1);
+    return n < 0 ? 0 : d_nodes[n].d_cls;
+}
+
+Declaration* ClassHierarchy::getSuper(const Declaration* cls) const
+{
+    const int n = node(cls);
+    if( n < 0 || d_nodes[n].d_super < 0 )
+        return 0;
+    return d_nodes[d_nodes[n].d_super].d_cls;
+}
+
+QList<Declaration*> ClassHierarchy::getSubs(const Declaration* cls) const
+{
+    QList<Declaration*> res;
+    const int n = node(cls);
+    if( n >= 0 )
+    {
+        foreach( int sub, d_nodes[n].d_subs )
+            res << d_nodes[sub].d_cls;
+    }
+    return res;
+}
+
+bool ClassHierarchy::isSubclassOf(const Declaration* sub, const Declaration* super) const
+{
+    const int a = node(sub);
+    const int b = node(super);
+    if( !d_frozen || a < 0 || b < 0 )
+        return false;
+    return d_nodes[b].d_pre <= d_nodes[a].d_pre && d_nodes[a].d_pre <= d_nodes[b].d_last;
+}
+
+Declaration* ClassHierarchy::getOverridden(const Declaration* method) const
+{
+    QHash<const Declaration*,quint32>::const_iterator i = d_byMethod.find(method);
+    if( i == d_byMethod.end() )
+        return 0;
+    return d_methods[i.value()].d_overridden;
+}
+
+QList<Declaration*> ClassHierarchy::getOverrides(const Declaration* method) const
+{
+    QList<Declaration*> res;
+    QHash<const Declaration*,quint32>::const_iterator i = d_byMethod.find(method);
+    if( i == d_byMethod.end() )
+        return res;
+    // the overrides are the methods of the chain which follow in the subtree of the class
+    const Method& me = d_methods[i.value()];
+    for( quint32 j = i.value() + 1; j < me.d_to && d_methods[j].d_pre <= me.d_last; j++ )
+        res << d_methods[j].d_meth;
+    return res;
+}
+
+void IncludeGraph::addInclude(CodeFile* unit, CodeFile* inc, const FilePos& loc)
+{
+    Q_ASSERT( unit && inc && inc->d_file );
+    Edge e;
+    e.d_unit = unit;
+    e.d_inc = inc;
+    e.d_file = inc->d_file;
+    e.d_loc = loc;
+    const quint32 i = d_edges.size();
+    d_edges.append(e);
+    d_byUnit[unit->d_file].append(i);
+    d_byInc[inc->d_file].append(i);
+}
+
+void IncludeGraph::moveIncludes(const QString& path, const RowCol& after, int rows)
+{
+    for( int i = 0; i < d_edges.size(); i++ )
+    {
+        FilePos& loc = d_edges[i].d_loc;
+        if( loc.d_filePath == path && after < loc.d_pos )
+            loc.d_pos.d_row += rows;
+    }
+}
+
+void IncludeGraph::clear()
+{
+    d_edges.clear();
+    d_byUnit.clear();
+    d_byInc.clear();
+}
+
+const IncludeGraph::Edges&IncludeGraph::getIncludes(const FileSystem::File* unit) const
+{
+    static const Edges s_empty;
+    QHash<const FileSystem::File*,Edges>::const_iterator i = d_byUnit.find(unit);
+    if( i == d_byUnit.end() )
+        return s_empty;
+    return i.value();
+}
+
+const IncludeGraph::Edges&IncludeGraph::getIncludedBy(const FileSystem::File* inc) const
+{
+    static const Edges s_empty;
+    QHash<const FileSystem::File*,Edges>::const_iterator i = d_byInc.find(inc);
+    if( i == d_byInc.end() )
+        return s_empty;
+    return i.value();
+}
+
+QList<CodeFile*> IncludeGraph::getUnits(const FileSystem::File* inc) const
+{
+    QList<CodeFile*> res;
+    foreach( quint32 i, getIncludedBy(inc) )
+    {
+        CodeFile* unit = d_edges[i].d_unit;
+        if( !res.contains(unit) )
+            res << unit;
+    }
+    return res;
+}
 
 ModuleDetailMdl::ModuleDetailMdl(QObject* parent)
 {
@@ -2264,17 +3222,11 @@ void ModuleDetailMdl::fillSubs(ModelItem* parentItem, Scope* scope)
 
 AsmFile::~AsmFile()
 {
-    if( d_impl )
-        delete d_impl;
-    QHash<QString,SymList>::const_iterator j;
-    for( j = d_syms.begin(); j != d_syms.end(); ++j )
-        for( int i = 0; i < j.value().size(); i++ )
-            delete j.value()[i];
     for( int i = 0; i < d_includes.size(); i++ )
         delete d_includes[i];
 }
 
-FilePos AsmInclude::getLoc() const
+FilePos AsmInclude::getIncludeLoc() const
 {
     if( d_file )
         return FilePos( RowCol(d_row,d_col), d_file->d_realPath );
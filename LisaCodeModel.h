@@ -22,9 +22,10 @@
 
 #include <QAbstractItemModel>
 #include <QHash>
+#include <QVector>
 #include <LisaFileSystem.h>
-#include <QSharedData>
 #include "LisaRowCol.h"
+#include "LisaPpLexer.h"
 
 namespace Lisa
 {
@@ -47,35 +48,50 @@ public:
     };
     quint8 d_kind;
 
-    virtual FilePos getLoc() const { return FilePos(); }
-    virtual quint16 getLen() const { return 0; }
-    virtual QString getName() const;
-    virtual const FileSystem::File* getFile() const { return 0; }
+    // no virtuals; dispatch on d_kind
+    FilePos getLoc() const;
+    quint16 getLen() const;
+    QString getName() const;
+    const FileSystem::File* getFile() const;
     bool isDeclaration() const { return d_kind >= Const && d_kind <= Self; }
+    bool isCodeFile() const { return d_kind >= Unit && d_kind <= Include; }
     const char* typeName() const;
     Thing():d_kind(Undefined){}
-    virtual ~Thing();
 };
 
-class Type : public QSharedData
+class Type
 {
 public:
-    typedef QExplicitlySharedDataPointer<Type> Ref;
     enum Kind { Undefined, Pointer, Array, Record, Class
               };
-    Type::Ref d_type;
-    Scope* d_members; // owns
+    Type* d_type; // base, element or super type; all types are owned by the TypeArena
+    Scope* d_members; // allocated in the Arena of the declaring file
     quint8 d_kind;
 
     Type():d_type(0), d_members(0),d_kind(Undefined) {}
-    ~Type();
+};
+
+class TypeArena
+{
+public:
+    Type* create(quint8 kind, Type* base = 0);
+    Type* shared(quint8 kind, Type* base); // hash-consed Pointer or Array of base
+    void clear();
+    int getCount() const { return d_types.size(); }
+    quint32 getRequests() const { return d_requests; } // number of types without sharing
+    TypeArena():d_requests(0){}
+    ~TypeArena() { clear(); }
+private:
+    QList<Type*> d_types; // owns
+    QHash<QPair<quint8,Type*>,Type*> d_shared;
+    quint32 d_requests;
 };
 
 class Declaration : public Thing
 {
 public:
-    Scope* d_body; // owns
-    Type::Ref d_type;
+    Scope* d_body;
+    Type* d_type;
     QByteArray d_name;
     const char* d_id; // same as in Token
 
@@ -88,28 +104,22 @@ public:
     Symbol* d_me; // this is the symbol by which the decl itself is represented in the file
     Declaration* d_impl; // points to implementation if this is in an interface or a forward
 
-    FilePos getLoc() const { return d_loc; }
-    quint16 getLen() const { return d_name.size(); }
-    QString getName() const;
-
     UnitFile* getUnitFile() const; // only for ownership, not for actual file position
     Declaration():d_body(0),d_owner(0),d_me(0),d_id(0),d_type(0),d_impl(0){}
-    ~Declaration();
 };
 
 class Scope : public Thing
 {
 public:
-    QList<Declaration*> d_order; // owns
+    QList<Declaration*> d_order; // decls are owned by the Arena of the declaring file
     Thing* d_owner; // either declaration or unit file or asm file or 0
     Scope* d_outer;
     Scope* d_altOuter; // to access params defined in interface declaration of func/proc
 
     UnitFile* getUnitFile() const;
     Declaration* findDecl(const char* id, bool withImports = true) const;
-    void clear();
+    void clear() { d_order.clear(); }
     Scope():d_owner(0),d_outer(0),d_altOuter(0){}
-    ~Scope();
 };
 
 class Symbol
@@ -120,6 +130,48 @@ public:
     Symbol():d_decl(0){}
 };
 
+template<class T>
+class Pool
+{
+public:
+    enum { ChunkSize = 256 };
+    T* alloc()
+    {
+        if( d_chunks.isEmpty() || d_used == ChunkSize )
+        {
+            d_chunks.append( new T[ChunkSize] );
+            d_used = 0;
+        }
+        return &d_chunks.last()[d_used++];
+    }
+    int size() const { return d_chunks.isEmpty() ? 0 : ( d_chunks.size() - 1 ) * ChunkSize + d_used; }
+    void clear()
+    {
+        for( int i = 0; i < d_chunks.size(); i++ )
+            delete[] d_chunks[i];
+        d_chunks.clear();
+        d_used = 0;
+    }
+    Pool():d_used(0){}
+    ~Pool() { clear(); }
+private:
+    QList<T*> d_chunks;
+    int d_used;
+};
+
+class Arena
+{
+public:
+    Declaration* newDecl() { return d_decls.alloc(); }
+    Scope* newScope() { return d_scopes.alloc(); }
+    Symbol* newSym() { return d_syms.alloc(); }
+    int getDeclCount() const { return d_decls.size(); }
+private:
+    Pool<Declaration> d_decls;
+    Pool<Scope> d_scopes;
+    Pool<Symbol> d_syms;
+};
+
 class IncludeFile;
 class UnitFile;
 class AsmFile;
@@ -137,10 +189,8 @@ public:
     AsmFile* toAsmFile();
     AsmInclude* toAsmInclude();
 
-    QString getName() const;
-    const FileSystem::File* getFile() const { return d_file; }
+    static void destroy(CodeFile*);
     CodeFile():d_file(0),d_folder(0) {}
-    ~CodeFile();
 };
 
 class IncludeFile : public CodeFile
@@ -149,24 +199,37 @@ public:
     UnitFile* d_unit;
     quint16 d_len; // just to make the symbol of the include directive happy
 
-    FilePos getLoc() const; // the landing place when we jump to this file
-    quint16 getLen() const { return d_len; }
+    FilePos getIncludeLoc() const; // the landing place when we jump to this file
     IncludeFile():d_unit(0),d_len(0){ d_kind = Include; }
 };
 
 class UnitFile : public CodeFile
 {
 public:
-    Scope* d_intf; // owns, 0 for Program
-    Scope* d_impl; // owns
+    Scope* d_intf; // 0 for Program
+    Scope* d_impl;
     Scope* d_globals;
     QList<UnitFile*> d_import;
     typedef QList<Symbol*> SymList;
-    QHash<QString,SymList> d_syms; // owns, all things we can click on in a code file ordered by row/col
+    QHash<QString,SymList> d_syms; // all things we can click on in a code file ordered by row/col
     QList<IncludeFile*> d_includes; // owns
+    Arena d_arena; // owns all scopes, declarations and symbols of this unit and its includes
+
+    struct Stream // the preprocessed tokens, as far as CodeModel::reparseRoutine needs them
+    {
+        enum { Foreign = 0xffffffff, CheckpointLines = 32 };
+        QVector<quint32> d_hash; // of type and value of each token
+        QVector<quint32> d_pos; // RowCol::packed() of each token, or Foreign if not located in the unit file
+        QHash<const Declaration*,Range> d_routines; // first and last terminal of each routine in the unit file
+        QList<PpLexer::Checkpoint> d_checkpoints; // where lexing can resume, every CheckpointLines
+        QByteArray d_source; // the content of the unit file the checkpoints refer to, shared with the store
+        quint32 d_sloc;
+        Stream():d_sloc(0){}
+    };
+    Stream* d_stream; // owns; only with CodeModel::setIncremental
 
     QByteArrayList findUses() const;
-    UnitFile():d_intf(0),d_impl(0),d_globals(0) { d_kind = Unit; }
+    UnitFile():d_intf(0),d_impl(0),d_globals(0),d_stream(0) { d_kind = Unit; }
     ~UnitFile();
 };
 
@@ -178,18 +241,18 @@ public:
     quint32 d_row;
     AsmFile* d_unit;
 
-    FilePos getLoc() const; // the landing place when we jump to this file
-    quint16 getLen() const { return d_len; }
+    FilePos getIncludeLoc() const; // the landing place when we jump to this file
     AsmInclude():d_len(0),d_col(0),d_row(0),d_unit(0){ d_kind = AsmIncl; }
 };
 
 class AsmFile : public CodeFile
 {
 public:
-    Scope* d_impl; // owns
+    Scope* d_impl;
     QList<AsmInclude*> d_includes; // owns
     typedef QList<Symbol*> SymList;
-    QHash<QString,SymList> d_syms; // owns, all things we can click on in a code file ordered by row/col
+    QHash<QString,SymList> d_syms; // all things we can click on in a code file ordered by row/col
+    Arena d_arena; // owns all scopes, declarations and symbols of this file and its includes
 
     AsmFile():d_impl(0){ d_kind = Assembler; }
     ~AsmFile();
@@ -202,12 +265,108 @@ public:
     QList<CodeFolder*> d_subs; // owns
     QList<CodeFile*> d_files; // owns
 
-    QString getName() const;
     void clear();
     CodeFolder():d_dir(0){ d_kind = Folder; }
     ~CodeFolder() { clear(); }
 };
 
+class CallGraph
+{
+public:
+    struct Call
+    {
+        Thing* d_caller; // Func/Proc declaration, or the UnitFile or AsmFile for code outside of routines
+        Declaration* d_callee;
+        FilePos d_loc; // the call site
+    };
+    typedef QPair<const quint32*,const quint32*> Range; // indices into getCall()
+
+    void addCall(Thing* caller, Declaration* callee, const FilePos& loc);
+    void freeze(); // builds the adjacency index; no calls can be added afterwards
+    void thaw(); // drops the index so calls can be added or removed again
+    void removeCalls(const QString& path, const RowCol& from, const RowCol& to); // all call sites in [from,to]
+    void moveCalls(const QString& path, const RowCol& after, int rows); // call sites behind after
+    void replace(const Declaration* old, Declaration* by); // as caller and callee
+    void clear();
+    Range getCallees(const Thing* caller) const;
+    Range getCallers(const Thing* callee) const;
+    const Call& getCall(quint32 i) const { return d_calls[i]; }
+    int getCallCount() const { return d_calls.size(); }
+    int getNodeCount() const { return d_nodes.size(); }
+    CallGraph():d_frozen(false){}
+private:
+    Range range(const QVector<quint32>& off, const QVector<quint32>& idx, const Thing*) const;
+    QVector<Call> d_calls;
+    QHash<const Thing*,quint32> d_nodes; // caller or callee -> node number
+    QVector<quint32> d_outOff, d_out; // calls grouped by caller; d_out[d_outOff[n]..d_outOff[n+1]]
+    QVector<quint32> d_inOff, d_in; // same grouped by callee
+    bool d_frozen;
+};
+
+class ClassHierarchy
+{
+public:
+    void addClass(Declaration* cls); // a TypeDecl of a Type::Class
+    void freeze(); // numbers the subtrees and builds the override chains; no classes can be added afterwards
+    void clear();
+    Declaration* getClass(const Type*) const;
+    Declaration* getSuper(const Declaration* cls) const;
+    QList<Declaration*> getSubs(const Declaration* cls) const; // direct subclasses only
+    bool isSubclassOf(const Declaration* sub, const Declaration* super) const; // true if sub == super
+    Declaration* getOverridden(const Declaration* method) const; // the method of the nearest superclass
+    QList<Declaration*> getOverrides(const Declaration* method) const; // all overriding methods in subclasses
+    int getClassCount() const { return d_nodes.size(); }
+    ClassHierarchy():d_frozen(false){}
+private:
+    int node(const Declaration* cls) const;
+    void number(int n, quint32& pre);
+    struct Node
+    {
+        Declaration* d_cls;
+        int d_super;
+        QList<int> d_subs;
+        quint32 d_pre, d_last; // the subtree of n are the nodes with d_pre in [n.d_pre,n.d_last]
+        Node():d_cls(0),d_super(-1),d_pre(0),d_last(0){}
+    };
+    struct Method
+    {
+        Declaration* d_meth;
+        Declaration* d_overridden;
+        quint32 d_pre, d_last; // of the class
+        quint32 d_from, d_to; // all methods of the same override chain are in d_methods[d_from,d_to)
+    };
+    QVector<Node> d_nodes;
+    QHash<const Type*,int> d_byType;
+    QVector<Method> d_methods; // grouped by chain, within chain ordered by d_pre
+    QHash<const Declaration*,quint32> d_byMethod;
+    bool d_frozen;
+};
+
+class IncludeGraph
+{
+public:
+    struct Edge
+    {
+        CodeFile* d_unit; // the UnitFile or AsmFile which was preprocessed
+        CodeFile* d_inc; // the IncludeFile or AsmInclude of the directive in d_unit
+        const FileSystem::File* d_file; // the included file
+        FilePos d_loc; // the include directive, either in the unit or in a nested include file
+    };
+    typedef QList<quint32> Edges; // indices into getEdge()
+
+    void addInclude(CodeFile* unit, CodeFile* inc, const FilePos& loc);
+    void moveIncludes(const QString& path, const RowCol& after, int rows); // directives behind after
+    void clear();
+    const Edges& getIncludes(const FileSystem::File* unit) const; // including nested includes
+    const Edges& getIncludedBy(const FileSystem::File* inc) const; // all directives of all units
+    QList<CodeFile*> getUnits(const FileSystem::File* inc) const; // distinct units depending on inc
+    const Edge& getEdge(quint32 i) const { return d_edges[i]; }
+    int getEdgeCount() const { return d_edges.size(); }
+private:
+    QVector<Edge> d_edges;
+    QHash<const FileSystem::File*,Edges> d_byUnit, d_byInc;
+};
+
 struct ModelItem
 {
     Thing* d_thing;
@@ -252,25 +411,49 @@ public:
     UnitFile* getUnitFile(const QString& path) const;
     AsmFile* getAsmFile(const QString& path) const;
     Scope* getGlobals() { return &d_globals; }
+    TypeArena* getTypes() { return &d_types; }
+    CallGraph* getCalls() { return &d_calls; }
+    ClassHierarchy* getClasses() { return &d_classes; }
+    IncludeGraph* getIncludes() { return &d_includes; }
     Ranges getMutes( const QString& path );
     int getErrCount() const { return d_errCount; }
+    quint32 getDedupFiles() const { return d_dedupFiles; }
+    quint32 getDedupSloc() const { return d_dedupSloc; }
+    void setIncremental(bool on) { d_incremental = on; } // takes effect with the next load
+    bool isIncremental() const { return d_incremental; }
+    bool reparseRoutine(Declaration* routine); // false and unchanged if the edit is not confined to the routine body
 
     // overrides
     QVariant data ( const QModelIndex & index, int role = Qt::DisplayRole ) const;
 protected:
     void parseAndResolve(UnitFile*);
     void parseAndResolve(AsmFile*);
+    void parseAsm(const QList<AsmFile*>&);
 
 private:
     void fillFolders(ModelItem* root, const FileSystem::Dir* super, CodeFolder* top, QList<ModelItem*>& fileSlots);
     FileSystem* d_fs;
     CodeFolder d_top;
     Scope d_globals;
+    TypeArena d_types;
+    CallGraph d_calls;
+    ClassHierarchy d_classes;
+    IncludeGraph d_includes;
     QHash<const FileSystem::File*,UnitFile*> d_map1;
-    QHash<QString,CodeFile*> d_map2; // real path -> file
+    QHash<QString,CodeFile*> d_map2; // real path -> file; an include file shared by units maps to the last one
     quint32 d_sloc; // number of lines of code without empty or comment lines
     QHash<QString,Ranges> d_mutes;
     int d_errCount;
+    struct PasParse;
+    struct AsmParse;
+    // byte-identical modules share one lexed, preprocessed and parsed result, but are resolved individually
+    QHash<QByteArray,int> d_hashCount; // content hash -> number of files not yet resolved
+    QHash<QByteArray,PasParse*> d_pasParses;
+    QHash<QByteArray,AsmParse*> d_asmParses;
+    class AsmTask;
+    QHash<const FileSystem::File*,AsmParse*> d_asmReady; // parsed in parallel by parseAsm, not yet resolved
+    quint32 d_dedupFiles, d_dedupSloc;
+    bool d_incremental;
 };
 
 class ModuleDetailMdl : public ItemModel
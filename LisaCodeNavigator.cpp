@@ -20,6 +20,7 @@
 #include "LisaCodeNavigator.h"
 #include "LisaHighlighter.h"
 #include "LisaCodeModel.h"
+#include "LisaPpLexer.h"
 #include <QApplication>
 #include <QFileInfo>
 #include <QtDebug>
@@ -33,6 +34,9 @@
 #include <QTreeView>
 #include <QTreeWidget>
 #include <QInputDialog>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QKeyEvent>
 #include <QFileDialog>
 #include <QTimer>
 #include <QElapsedTimer>
@@ -40,7 +44,9 @@
 using namespace Lisa;
 
 Q_DECLARE_METATYPE(Symbol*)
+Q_DECLARE_METATYPE(const Thing*)
 Q_DECLARE_METATYPE(FilePos)
+Q_DECLARE_METATYPE(const FileSystem::File*)
 
 static CodeNavigator* s_this = 0;
 static void report(QtMsgType type, const QString& message )
@@ -131,17 +137,15 @@ public:
             return true;
         d_path = path;
 
-        QFile in(d_path);
-        if( !in.open(QIODevice::ReadOnly) )
+        SourceStore* store = that()->d_mdl->getFs()->getStore();
+        if( store->get(d_path).isNull() )
             return false;
         CodeFile* cf = that()->d_mdl->getCodeFile(path);
         if( cf && ( cf->d_kind == Thing::Unit || cf->d_kind == Thing::Include ))
             d_hl1->setDocument(document());
         else if( cf && ( cf->d_kind == Thing::Assembler|| cf->d_kind == Thing::AsmIncl ) )
             d_hl2->setDocument(document());
-        QByteArray buf = in.readAll();
-        buf.chop(1);
-        setPlainText( QString::fromLatin1(buf) );
+        setPlainText( store->getText(d_path) );
         markMutes( that()->d_mdl->getMutes(path) );
         markMissing();
         that()->syncModuleList();
@@ -450,6 +454,7 @@ CodeNavigator::CodeNavigator(QWidget *parent) : QMainWindow(parent),d_pushBackLo
     createModuleList();
     createDetails();
     createUsedBy();
+    createCalls();
     createLog();
 
     connect( d_view, SIGNAL( cursorPositionChanged() ), this, SLOT(  onCursorPositionChanged() ) );
@@ -468,6 +473,7 @@ CodeNavigator::CodeNavigator(QWidget *parent) : QMainWindow(parent),d_pushBackLo
     new QShortcut(tr("F3"),this,SLOT(onFindAgain()) );
     new QShortcut(tr("F2"),this,SLOT(onGotoDefinition()) );
     new QShortcut(tr("CTRL+O"),this,SLOT(onOpen()) );
+    new QShortcut(tr("CTRL+P"),this,SLOT(onQuickOpen()) );
     new QShortcut(Qt::CTRL + Qt::Key_Plus,this,SLOT(onIncreaseSize()) );
     new QShortcut(Qt::CTRL + Qt::Key_Minus,this,SLOT(onDecreaseSize()) );
 
@@ -480,8 +486,9 @@ CodeNavigator::CodeNavigator(QWidget *parent) : QMainWindow(parent),d_pushBackLo
                .arg( qApp->applicationVersion() ).arg( qApp->organizationName() ).arg( qApp->organizationDomain() ));
     logMessage(tr("Shortcuts:"));
     logMessage(tr("CTRL+O to open the directory containing the Lisa Pascal files") );
-    logMessage(tr("Double-click on the elements in the Modules or Uses lists to show in source code") );
+    logMessage(tr("Double-click on the elements in the Modules, Uses or Call Hierarchy lists to show in source code") );
     logMessage(tr("CTRL-click or F2 on the idents in the source to navigate to declarations") );
+    logMessage(tr("CTRL+P to open a file by typing (some of the letters of) its name or path") );
     logMessage(tr("CTRL+L to go to a specific line in the source code file") );
     logMessage(tr("CTRL+F to find a string in the current file") );
     logMessage(tr("CTRL+G or F3 to find another match in the current file") );
@@ -501,6 +508,8 @@ void CodeNavigator::open(const QString& sourceTreePath)
 {
     d_msgLog->clear();
     d_usedBy->clear();
+    d_calls->clear();
+    d_callsTitle->clear();
     d_view->d_path.clear();
     d_view->clear();
     d_pathTitle->clear();
@@ -585,6 +594,34 @@ void CodeNavigator::createUsedBy()
     connect(d_usedBy, SIGNAL(itemDoubleClicked(QTreeWidgetItem*,int)), this, SLOT(onUsedByDblClicked()) );
 }
 
+void CodeNavigator::createCalls()
+{
+    QDockWidget* dock = new QDockWidget( tr("Call Hierarchy"), this );
+    dock->setObjectName("Calls");
+    dock->setAllowedAreas( Qt::AllDockWidgetAreas );
+    dock->setFeatures( QDockWidget::DockWidgetMovable );
+    QWidget* pane = new QWidget(dock);
+    QVBoxLayout* vbox = new QVBoxLayout(pane);
+    vbox->setMargin(0);
+    vbox->setSpacing(0);
+    d_callsTitle = new QLabel(pane);
+    d_callsTitle->setWordWrap(true);
+    d_callsTitle->setMargin(2);
+    vbox->addWidget(d_callsTitle);
+    d_calls = new QTreeWidget(pane);
+    d_calls->setAlternatingRowColors(true);
+    d_calls->setHeaderHidden(true);
+    d_calls->setSortingEnabled(false);
+    d_calls->setAllColumnsShowFocus(true);
+    d_calls->setRootIsDecorated(true);
+    d_calls->setExpandsOnDoubleClick(false);
+    vbox->addWidget(d_calls);
+    dock->setWidget(pane);
+    addDockWidget( Qt::RightDockWidgetArea, dock );
+    connect(d_calls, SIGNAL(itemDoubleClicked(QTreeWidgetItem*,int)), this, SLOT(onCallsDblClicked()) );
+    connect(d_calls, SIGNAL(itemExpanded(QTreeWidgetItem*)), this, SLOT(onCallsExpanded(QTreeWidgetItem*)) );
+}
+
 void CodeNavigator::createLog()
 {
     QDockWidget* dock = new QDockWidget( tr("Message Log"), this );
@@ -681,10 +718,120 @@ void CodeNavigator::fillUsedBy(Symbol* id, Declaration* nt)
                 curItem = item;
         }
     }
+
+    // class hierarchy relations of classes and methods
+    ClassHierarchy* ch = d_mdl->getClasses();
+    QList< QPair<QString,Declaration*> > rel;
+    if( nt->d_kind == Thing::TypeDecl )
+    {
+        Declaration* super = ch->getSuper(nt);
+        if( super )
+            rel << qMakePair(tr("subclass of"), super);
+        foreach( Declaration* sub, ch->getSubs(nt) )
+            rel << qMakePair(tr("superclass of"), sub);
+    }else if( nt->d_kind == Thing::Func || nt->d_kind == Thing::Proc )
+    {
+        Declaration* overridden = ch->getOverridden(nt);
+        if( overridden )
+            rel << qMakePair(tr("overrides"), overridden);
+        foreach( Declaration* o, ch->getOverrides(nt) )
+            rel << qMakePair(tr("overridden by"), o);
+    }
+    for( int i = 0; i < rel.size(); i++ )
+    {
+        Declaration* d = rel[i].second;
+        const FileSystem::File* file = d_mdl->getFs()->findFile(d->d_loc.d_filePath);
+        const QString fileName = file ? file->getVirtualPath(false) : QFileInfo(d->d_loc.d_filePath).fileName();
+        QTreeWidgetItem* item = new QTreeWidgetItem(d_usedBy);
+        item->setText( 0, QString("%1 %2 - %3 %4:%5").arg(rel[i].first).arg(d->d_name.constData()).arg(fileName)
+                       .arg(d->d_loc.d_pos.d_row).arg(d->d_loc.d_pos.d_col) );
+        QFont f = item->font(0);
+        f.setItalic(true);
+        item->setFont(0,f);
+        item->setToolTip( 0, item->text(0) );
+        item->setData( 0, Qt::UserRole, QVariant::fromValue(d->d_loc) );
+        item->setData( 0, Qt::UserRole+1, QVariant::fromValue(d->d_me) );
+    }
+
     if( curItem )
         d_usedBy->scrollToItem( curItem );
 }
 
+void CodeNavigator::fillIncludedBy(Symbol* id, const FileSystem::File* inc)
+{
+    d_usedBy->clear();
+    d_usedByTitle->setText(QString("Include '%1'").arg(inc->getVirtualPath(false)) );
+
+    const IncludeGraph* ig = d_mdl->getIncludes();
+    QTreeWidgetItem* curItem = 0;
+    foreach( quint32 i, ig->getIncludedBy(inc) )
+    {
+        const IncludeGraph::Edge& e = ig->getEdge(i);
+        const FileSystem::File* file = d_mdl->getFs()->findFile(e.d_loc.d_filePath);
+        const QString fileName = file ? file->getVirtualPath(false) : QFileInfo(e.d_loc.d_filePath).fileName();
+        QTreeWidgetItem* item = new QTreeWidgetItem(d_usedBy);
+        if( e.d_loc.d_filePath == e.d_unit->d_file->d_realPath )
+            item->setText( 0, QString("%1 %2:%3").arg(fileName)
+                           .arg(e.d_loc.d_pos.d_row).arg(e.d_loc.d_pos.d_col) );
+        else
+            item->setText( 0, QString("%1 %2:%3 - via %4").arg(e.d_unit->d_file->getVirtualPath(false))
+                           .arg(e.d_loc.d_pos.d_row).arg(e.d_loc.d_pos.d_col).arg(fileName) );
+        if( id && e.d_loc.d_pos == id->d_loc && e.d_loc.d_filePath == d_view->d_path && curItem == 0 )
+        {
+            QFont f = item->font(0);
+            f.setBold(true);
+            item->setFont(0,f);
+            curItem = item;
+        }
+        item->setToolTip( 0, item->text(0) );
+        item->setData( 0, Qt::UserRole, QVariant::fromValue(e.d_loc) );
+        if( e.d_loc.d_filePath != d_view->d_path )
+            item->setForeground( 0, Qt::gray );
+    }
+    if( curItem )
+        d_usedBy->scrollToItem( curItem );
+}
+
+void CodeNavigator::fillCalls(Declaration* d)
+{
+    d_calls->clear();
+    d_callsTitle->setText(QString("%1 '%2'").arg(d->typeName()).arg(d->d_name.data()) );
+
+    QTreeWidgetItem* callers = new QTreeWidgetItem(d_calls);
+    callers->setText(0, tr("Called by"));
+    addCallItems(callers, d, true);
+    callers->setExpanded(true);
+
+    QTreeWidgetItem* callees = new QTreeWidgetItem(d_calls);
+    callees->setText(0, tr("Calls"));
+    addCallItems(callees, d, false);
+    callees->setExpanded(true);
+}
+
+void CodeNavigator::addCallItems(QTreeWidgetItem* parent, const Thing* node, bool callers)
+{
+    const CallGraph* cg = d_mdl->getCalls();
+    const CallGraph::Range r = callers ? cg->getCallers(node) : cg->getCallees(node);
+    for( const quint32* i = r.first; i != r.second; ++i )
+    {
+        const CallGraph::Call& c = cg->getCall(*i);
+        const Thing* other = callers ? c.d_caller : c.d_callee;
+        const FileSystem::File* file = d_mdl->getFs()->findFile(c.d_loc.d_filePath);
+        const QString fileName = file ? file->getVirtualPath(false) : QFileInfo(c.d_loc.d_filePath).fileName();
+        QTreeWidgetItem* item = new QTreeWidgetItem(parent);
+        item->setText( 0, QString("%1 - %2 %3:%4").arg(other->getName()).arg(fileName)
+                       .arg(c.d_loc.d_pos.d_row).arg(c.d_loc.d_pos.d_col) );
+        item->setToolTip( 0, item->text(0) );
+        item->setData( 0, Qt::UserRole, QVariant::fromValue(c.d_loc) );
+        item->setData( 0, Qt::UserRole+1, QVariant::fromValue(other) );
+        item->setData( 0, Qt::UserRole+2, callers );
+        // the next level is only filled when expanded, since the graph has cycles
+        item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+    }
+    if( parent->childCount() == 0 )
+        parent->setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicatorWhenChildless);
+}
+
 void CodeNavigator::setPathTitle(const FileSystem::File* f, int row, int col)
 {
     if( f == 0 )
@@ -737,6 +884,8 @@ void CodeNavigator::onCursorPositionChanged()
     {
         Declaration* d = static_cast<Declaration*>(id->d_decl);
         fillUsedBy( id, d );
+        if( d->d_kind == Thing::Func || d->d_kind == Thing::Proc )
+            fillCalls( d );
 
         // mark all symbols in file which have the same declaration
         QList<Symbol*> syms = d->d_refs.value(d_view->d_path);
@@ -750,6 +899,11 @@ void CodeNavigator::onCursorPositionChanged()
             d_module->setCurrentIndex(i);
             d_module->scrollTo( i ,QAbstractItemView::EnsureVisible );
         }
+    }else if( id && id->d_decl && ( id->d_decl->d_kind == Thing::Include || id->d_decl->d_kind == Thing::AsmIncl ) )
+    {
+        const CodeFile* inc = static_cast<const CodeFile*>(id->d_decl);
+        if( inc->d_file )
+            fillIncludedBy( id, inc->d_file );
     }
 }
 
@@ -799,6 +953,26 @@ void CodeNavigator::onUsedByDblClicked()
     d_view->setPosition( pos, true, true );
 }
 
+void CodeNavigator::onCallsDblClicked()
+{
+    if( d_calls->currentItem() == 0 )
+        return;
+
+    FilePos pos = d_calls->currentItem()->data(0,Qt::UserRole).value<FilePos>();
+    if( pos.d_filePath.isEmpty() )
+        return;
+    d_view->setPosition( pos, true, true );
+}
+
+void CodeNavigator::onCallsExpanded(QTreeWidgetItem* item)
+{
+    if( item->childCount() != 0 )
+        return;
+    const Thing* node = item->data(0,Qt::UserRole+1).value<const Thing*>();
+    if( node )
+        addCallItems(item, node, item->data(0,Qt::UserRole+2).toBool());
+}
+
 void CodeNavigator::onGoBack()
 {
     if( d_backHisto.size() <= 1 )
@@ -867,6 +1041,14 @@ void CodeNavigator::onGotoDefinition()
         d_view->setPosition( id, true, true );
 }
 
+void CodeNavigator::onQuickOpen()
+{
+    QuickOpen dlg(&d_index, this);
+    const FileSystem::File* f = dlg.select();
+    if( f )
+        d_view->setPosition( FilePos(RowCol(1,1),f->d_realPath), false, true );
+}
+
 void CodeNavigator::onOpen()
 {
     QString path = QFileDialog::getExistingDirectory(this,tr("Open Project Directory"),QDir::currentPath() );
@@ -881,9 +1063,15 @@ void CodeNavigator::onRunReload()
     t.start();
     QApplication::setOverrideCursor(Qt::WaitCursor);
     d_mdl->load(d_dir);
+    d_index.build(d_mdl->getFs());
     QApplication::restoreOverrideCursor();
     qDebug() << "parsed" << d_mdl->getSloc() << "SLOC in" << t.elapsed() << "[ms]";
     qDebug() << "with" << d_mdl->getErrCount() << "errors";
+    qDebug() << "include cache" << IncludeCache::instance()->getHits() << "hits"
+             << IncludeCache::instance()->getMisses() << "misses" << IncludeCache::instance()->getBytes() << "bytes";
+    qDebug() << "deduplicated" << d_mdl->getDedupFiles() << "identical files with" << d_mdl->getDedupSloc() << "SLOC";
+    qDebug() << "allocated" << d_mdl->getTypes()->getCount() << "types for" <<
+                d_mdl->getTypes()->getRequests() << "type constructions";
 }
 
 void CodeNavigator::onIncreaseSize()
@@ -900,6 +1088,67 @@ void CodeNavigator::onDecreaseSize()
     d_view->setFont(f);
 }
 
+QuickOpen::QuickOpen(const FileIndex* index, QWidget* parent):QDialog(parent),d_index(index)
+{
+    setWindowTitle(tr("Quick Open"));
+    QVBoxLayout* vbox = new QVBoxLayout(this);
+    d_edit = new QLineEdit(this);
+    d_edit->setPlaceholderText(tr("file name, module or path"));
+    vbox->addWidget(d_edit);
+    d_list = new QListWidget(this);
+    d_list->setAlternatingRowColors(true);
+    vbox->addWidget(d_list);
+    resize(600,400);
+    d_edit->installEventFilter(this);
+    connect( d_edit, SIGNAL(textChanged(QString)), this, SLOT(onFilter(QString)) );
+    connect( d_edit, SIGNAL(returnPressed()), this, SLOT(accept()) );
+    connect( d_list, SIGNAL(itemDoubleClicked(QListWidgetItem*)), this, SLOT(accept()) );
+    onFilter(QString());
+}
+
+const FileSystem::File*QuickOpen::select()
+{
+    if( exec() != QDialog::Accepted || d_list->currentItem() == 0 )
+        return 0;
+    return d_list->currentItem()->data(Qt::UserRole).value<const FileSystem::File*>();
+}
+
+bool QuickOpen::eventFilter(QObject* obj, QEvent* e)
+{
+    if( obj == d_edit && e->type() == QEvent::KeyPress )
+    {
+        // the selection in the list is moved while typing in the edit
+        switch( static_cast<QKeyEvent*>(e)->key() )
+        {
+        case Qt::Key_Up:
+        case Qt::Key_Down:
+        case Qt::Key_PageUp:
+        case Qt::Key_PageDown:
+            QApplication::sendEvent(d_list, e);
+            return true;
+        default:
+            break;
+        }
+    }
+    return QDialog::eventFilter(obj,e);
+}
+
+void QuickOpen::onFilter(const QString& str)
+{
+    d_list->clear();
+    const QList<FileIndex::Hit> hits = d_index->find(str);
+    foreach( const FileIndex::Hit& h, hits )
+    {
+        const QString path = h.d_file->getVirtualPath();
+        QListWidgetItem* item = new QListWidgetItem(d_list);
+        item->setText(QString("%1   %2").arg(path.mid(path.lastIndexOf('/') + 1)).arg(path));
+        item->setToolTip(h.d_file->d_realPath);
+        item->setData(Qt::UserRole, QVariant::fromValue(h.d_file));
+    }
+    if( d_list->count() )
+        d_list->setCurrentRow(0);
+}
+
 
 int main(int argc, char *argv[])
 {
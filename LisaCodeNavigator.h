@@ -21,13 +21,18 @@
 */
 
 #include <QMainWindow>
+#include <QDialog>
 #include "LisaRowCol.h"
 #include "LisaFileSystem.h"
+#include "LisaFileIndex.h"
 
 class QLabel;
+class QLineEdit;
+class QListWidget;
 class QPlainTextEdit;
 class QTreeView;
 class QTreeWidget;
+class QTreeWidgetItem;
 class QModelIndex;
 
 namespace Lisa
@@ -36,6 +41,26 @@ class CodeModel;
 class ModuleDetailMdl;
 class Symbol;
 class Declaration;
+class Thing;
+
+class QuickOpen : public QDialog
+{
+    Q_OBJECT
+public:
+    QuickOpen(const FileIndex*, QWidget* parent);
+    const FileSystem::File* select(); // null if canceled
+
+protected:
+    bool eventFilter(QObject*, QEvent*);
+
+protected slots:
+    void onFilter(const QString&);
+
+private:
+    const FileIndex* d_index;
+    QLineEdit* d_edit;
+    QListWidget* d_list;
+};
 
 class CodeNavigator : public QMainWindow
 {
@@ -61,10 +86,14 @@ protected:
     void createModuleList();
     void createDetails();
     void createUsedBy();
+    void createCalls();
     void createLog();
     void pushLocation( const Place& );
     void showViewer( const Place& );
     void fillUsedBy(Symbol* id, Declaration*);
+    void fillIncludedBy(Symbol* id, const FileSystem::File*);
+    void fillCalls(Declaration*);
+    void addCallItems(QTreeWidgetItem* parent, const Thing* node, bool callers);
     void setPathTitle(const FileSystem::File* f, int row, int col);
     void syncModuleList();
 
@@ -76,12 +105,15 @@ protected slots:
     void onModuleDblClick(const QModelIndex&);
     void onItemDblClick(const QModelIndex&);
     void onUsedByDblClicked();
+    void onCallsDblClicked();
+    void onCallsExpanded(QTreeWidgetItem*);
     void onGoBack();
     void onGoForward();
     void onGotoLine();
     void onFindInFile();
     void onFindAgain();
     void onGotoDefinition();
+    void onQuickOpen();
     void onOpen();
     void onRunReload();
     void onIncreaseSize();
@@ -96,8 +128,11 @@ private:
     QTreeView* d_module;
     QLabel* d_usedByTitle;
     QTreeWidget* d_usedBy;
+    QLabel* d_callsTitle;
+    QTreeWidget* d_calls;
     CodeModel* d_mdl;
     ModuleDetailMdl* d_mdl2;
+    FileIndex d_index; // for onQuickOpen, rebuilt on each reload
     QString d_dir;
 
     QList<Place> d_backHisto; // d_backHisto.last() is current place
@@ -0,0 +1,224 @@
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+#include "LisaFileIndex.h"
+#include <algorithm>
+using namespace Lisa;
+
+// a match of the file name counts more than one of the module name, which counts more than the path
+static const int s_keyBonus[] = { 24, 16, 0 };
+
+static inline int bit(char ch)
+{
+    if( ch >= 'a' && ch <= 'z' )
+        return ch - 'a';
+    if( ch >= '0' && ch <= '9' )
+        return 26;
+    switch( ch )
+    {
+    case '_':
+        return 27;
+    case '.':
+        return 28;
+    case '/':
+        return 29;
+    case '-':
+        return 30;
+    default:
+        return 31;
+    }
+}
+
+static inline bool isSeparator(char ch)
+{
+    return ch == '/' || ch == '_' || ch == '.' || ch == '-' || ch == ' ';
+}
+
+namespace
+{
+struct ByScore
+{
+    bool operator()(const FileIndex::Hit& lhs, const FileIndex::Hit& rhs) const
+    {
+        if( lhs.d_score != rhs.d_score )
+            return lhs.d_score > rhs.d_score;
+        return lhs.d_file->d_virtualPath < rhs.d_file->d_virtualPath;
+    }
+};
+
+struct ByPath
+{
+    bool operator()(const FileSystem::File* lhs, const FileSystem::File* rhs) const
+    {
+        return lhs->d_virtualPath < rhs->d_virtualPath;
+    }
+};
+}
+
+void FileIndex::build(const FileSystem* fs)
+{
+    clear();
+    QList<const FileSystem::File*> files;
+    collect(&fs->getRoot(), files);
+    std::sort(files.begin(), files.end(), ByPath());
+    foreach( const FileSystem::File* f, files )
+    {
+        const QByteArray keys[KeyCount] = { f->d_name.toLatin1().toLower(), f->d_moduleLc,
+                                            f->getVirtualPath().toLatin1().toLower() };
+        Entry e;
+        e.d_file = f;
+        e.d_all = 0;
+        for( int k = 0; k < KeyCount; k++ )
+        {
+            e.d_off[k] = d_text.size();
+            e.d_len[k] = qMin(keys[k].size(), 0xffff);
+            e.d_mask[k] = mask(keys[k].constData(), e.d_len[k]);
+            e.d_all |= e.d_mask[k];
+            d_text += keys[k].left(e.d_len[k]);
+        }
+        d_entries.append(e);
+    }
+}
+
+void FileIndex::clear()
+{
+    d_entries.clear();
+    d_text.clear();
+}
+
+QList<FileIndex::Hit> FileIndex::find(const QString& query, int max) const
+{
+    QByteArray q;
+    foreach( QChar ch, query.toLower() )
+    {
+        if( !ch.isSpace() )
+            q += ch.toLatin1();
+    }
+    QList<Hit> res;
+    if( q.isEmpty() )
+    {
+        for( int i = 0; i < d_entries.size() && i < max; i++ )
+        {
+            Hit h;
+            h.d_file = d_entries[i].d_file;
+            h.d_score = 0;
+            res.append(h);
+        }
+        return res;
+    }
+    const quint32 qm = mask(q.constData(), q.size());
+    const char* text = d_text.constData();
+    QVector<Hit> hits;
+    foreach( const Entry& e, d_entries )
+    {
+        if( ( e.d_all & qm ) != qm )
+            continue;
+        int best = -1;
+        for( int k = 0; k < KeyCount; k++ )
+        {
+            if( ( e.d_mask[k] & qm ) != qm )
+                continue;
+            const int s = score(text + e.d_off[k], e.d_len[k], q.constData(), q.size());
+            if( s >= 0 && s + s_keyBonus[k] > best )
+                best = s + s_keyBonus[k];
+        }
+        if( best >= 0 )
+        {
+            Hit h;
+            h.d_file = e.d_file;
+            h.d_score = best;
+            hits.append(h);
+        }
+    }
+    const int n = qMin(max, hits.size());
+    std::partial_sort(hits.begin(), hits.begin() + n, hits.end(), ByScore());
+    for( int i = 0; i < n; i++ )
+        res.append(hits[i]);
+    return res;
+}
+
+quint32 FileIndex::mask(const char* str, int len)
+{
+    quint32 res = 0;
+    for( int i = 0; i < len; i++ )
+        res |= 1u << bit(str[i]);
+    return res;
+}
+
+int FileIndex::score(const char* str, int len, const char* query, int qlen)
+{
+    // each window ends where the query is first completed behind the start of the previous window;
+    // going back from there gives the shortest window, which is scored; the best window counts
+    bool found = false;
+    int best = 0;
+    int from = 0;
+    while( from < len )
+    {
+        int j = 0;
+        int end = -1;
+        for( int i = from; i < len; i++ )
+        {
+            if( str[i] == query[j] && ++j == qlen )
+            {
+                end = i;
+                break;
+            }
+        }
+        if( end < 0 )
+            break;
+        // matches at the start of a segment and consecutive matches count more, skipped characters less
+        int res = 0;
+        int next = -2; // position of the match of the following query character
+        int start = from;
+        j = qlen - 1;
+        for( int i = end; i >= from; i-- )
+        {
+            if( str[i] != query[j] )
+                continue;
+            res += 16;
+            if( i == 0 || isSeparator(str[i-1]) )
+                res += 8;
+            if( next == i + 1 )
+                res += 8;
+            next = i;
+            if( j-- == 0 )
+            {
+                start = i;
+                break;
+            }
+        }
+        res -= end - start + 1 - qlen;
+        if( start == 0 )
+            res += 8;
+        best = found ? qMax(best, res) : res;
+        found = true;
+        from = start + 1;
+    }
+    if( !found )
+        return -1;
+    if( len == qlen )
+        best += 32;
+    best -= ( len - qlen ) / 8; // prefer the shorter of otherwise equal keys
+    return qMax(best, 0);
+}
+
+void FileIndex::collect(const FileSystem::Dir* dir, QList<const FileSystem::File*>& res)
+{
+    foreach( const FileSystem::File* f, dir->d_files )
+        res.append(f);
+    foreach( const FileSystem::Dir* sub, dir->d_subdirs )
+        collect(sub, res);
+}
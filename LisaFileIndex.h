@@ -0,0 +1,63 @@
+#ifndef LISAFILEINDEX_H
+#define LISAFILEINDEX_H
+
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+#include <QVector>
+#include "LisaFileSystem.h"
+
+namespace Lisa
+{
+// Finds files of the FileSystem by name, module name or virtual path, where the query may skip
+// characters ("lbpsl" finds "libpl/paslib"). The keys are kept lower-case in one buffer, each with a
+// bitmask of the characters it contains, so most files are rejected without looking at the key.
+// The File pointers are valid until the FileSystem is loaded again; then build() must be called.
+class FileIndex
+{
+public:
+    struct Hit
+    {
+        const FileSystem::File* d_file;
+        int d_score;
+    };
+
+    FileIndex() {}
+    void build(const FileSystem*);
+    void clear();
+    int getCount() const { return d_entries.size(); }
+    // the best matches ordered by descending score; all files by virtual path if the query is empty
+    QList<Hit> find(const QString& query, int max = 50) const;
+
+    static quint32 mask(const char* str, int len);
+    static int score(const char* str, int len, const char* query, int qlen); // -1 if no match
+private:
+    enum Key { Name, Module, Path, KeyCount };
+    struct Entry
+    {
+        const FileSystem::File* d_file;
+        quint32 d_off[KeyCount]; // into d_text
+        quint16 d_len[KeyCount];
+        quint32 d_mask[KeyCount];
+        quint32 d_all; // union of d_mask
+    };
+    static void collect(const FileSystem::Dir*, QList<const FileSystem::File*>&);
+    QVector<Entry> d_entries; // sorted by virtual path
+    QByteArray d_text;
+};
+}
+
+#endif // LISAFILEINDEX_H
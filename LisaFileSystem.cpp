@@ -18,11 +18,19 @@
 #include "Converter.h"
 #include "LisaLexer.h"
 #include "AsmLexer.h"
+#include <QBuffer>
 #include <QFile>
+#include <QCryptographicHash>
+#include <QThreadPool>
 #include <QtDebug>
+#include <algorithm>
+#ifdef Q_OS_UNIX
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
 using namespace Lisa;
 
-FileSystem::FileSystem(QObject *parent) : QObject(parent)
+FileSystem::FileSystem(QObject *parent) : QObject(parent),d_lookups(0),d_lookupHits(0)
 {
 
 }
@@ -46,46 +54,178 @@ static QString replaceLast(const QString& path, const QString& newLast )
     return segs.join('/');
 }
 
-static QStringList collectFiles( const QDir& dir, const QStringList& suffix )
+#ifdef Q_OS_UNIX
+namespace
+{
+// Parallel directory walk; each directory is read by a task of the pool which starts the tasks for
+// its subdirectories. The directory tree is kept, so the result can be flattened in the order of
+// the former QDir based implementation: first the subdirectories, then the files, each sorted by name.
+struct WalkNode
+{
+    QByteArray d_path; // native, with trailing slash
+    QList<QByteArray> d_files; // names which passed the filter
+    QList<WalkNode*> d_subs;
+    ~WalkNode() { foreach( WalkNode* n, d_subs ) delete n; }
+};
+
+class WalkTask : public QRunnable
+{
+public:
+    WalkTask(WalkNode* node, const QList<QByteArray>& suffix, QThreadPool* pool):
+        d_node(node),d_suffix(suffix),d_pool(pool){}
+    void run()
+    {
+        DIR* d = ::opendir(d_node->d_path.constData());
+        if( d == 0 )
+            return;
+        QList<QByteArray> subs;
+        while( struct dirent* e = ::readdir(d) )
+        {
+            const char* name = e->d_name;
+            if( name[0] == '.' )
+                continue; // includes . and .., and hidden entries as with QDir
+            bool isDir = e->d_type == DT_DIR;
+            bool isFile = e->d_type == DT_REG;
+            if( e->d_type == DT_UNKNOWN || e->d_type == DT_LNK )
+            {
+                struct stat st;
+                if( ::fstatat(::dirfd(d), name, &st, 0) != 0 )
+                    continue;
+                isDir = S_ISDIR(st.st_mode);
+                isFile = S_ISREG(st.st_mode);
+            }
+            if( isDir )
+                subs.append(QByteArray(name));
+            else if( isFile && matches(name) )
+                d_node->d_files.append(QByteArray(name));
+        }
+        ::closedir(d);
+        std::sort(d_node->d_files.begin(), d_node->d_files.end());
+        std::sort(subs.begin(), subs.end());
+        foreach( const QByteArray& sub, subs )
+        {
+            WalkNode* node = new WalkNode();
+            node->d_path = d_node->d_path + sub + '/';
+            d_node->d_subs.append(node);
+        }
+        foreach( WalkNode* sub, d_node->d_subs )
+            d_pool->start(new WalkTask(sub, d_suffix, d_pool));
+    }
+    bool matches(const char* name) const
+    {
+        const int len = ::strlen(name);
+        foreach( const QByteArray& suf, d_suffix )
+        {
+            if( len >= suf.size() && qstrnicmp(name + len - suf.size(), suf.constData(), suf.size()) == 0 )
+                return true;
+        }
+        return false;
+    }
+private:
+    WalkNode* d_node;
+    QList<QByteArray> d_suffix;
+    QThreadPool* d_pool;
+};
+
+void flatten(const WalkNode* node, QStringList& res)
+{
+    foreach( const WalkNode* sub, node->d_subs )
+        flatten(sub, res);
+    foreach( const QByteArray& f, node->d_files )
+        res.append(QFile::decodeName(node->d_path + f));
+}
+}
+
+QStringList FileSystem::collectFiles(const QString& dir, const QStringList& suffix)
+{
+    // only patterns of the form "*.suf" are supported, matched case insensitive as QDir does
+    QList<QByteArray> suf;
+    foreach( const QString& s, suffix )
+        suf.append(QFile::encodeName(s.startsWith('*') ? s.mid(1) : s));
+    WalkNode root;
+    root.d_path = QFile::encodeName(QDir(dir).absolutePath());
+    if( !root.d_path.endsWith('/') )
+        root.d_path += '/';
+    QThreadPool pool;
+    pool.start(new WalkTask(&root, suf, &pool));
+    pool.waitForDone();
+    QStringList res;
+    flatten(&root, res);
+    return res;
+}
+#else
+QStringList FileSystem::collectFiles(const QString& dir, const QStringList& suffix)
 {
     QStringList res;
-    QStringList files = dir.entryList( QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name );
+    QDir d(dir);
+    QStringList files = d.entryList( QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name );
 
     foreach( const QString& f, files )
-        res += collectFiles( QDir( dir.absoluteFilePath(f) ), suffix );
+        res += collectFiles( d.absoluteFilePath(f), suffix );
 
-    files = dir.entryList( suffix, QDir::Files, QDir::Name );
+    files = d.entryList( suffix, QDir::Files, QDir::Name );
     foreach( const QString& f, files )
     {
-        res.append(dir.absoluteFilePath(f));
+        res.append(d.absoluteFilePath(f));
     }
     return res;
 }
+#endif
 
 bool FileSystem::load(const QString& rootDir)
 {
+    const QStringList suffix = QStringList() << "*.txt" << "*.pas" << "*.inc";
+    QStringList files;
+    QVector<QByteArray> content; // of the archive members, inflated in parallel
     QFileInfo dirInfo(rootDir.endsWith('/') ? rootDir : rootDir + "/");
-    if( !dirInfo.isDir() )
-        return error("not a directory");
-
-    d_root.clear();
-    d_fileMap.clear();
-    d_moduleMap.clear();
+    if( dirInfo.isDir() )
+    {
+        clear();
+        d_rootDir = dirInfo.absolutePath();
+        files = collectFiles(d_rootDir,suffix);
+    }else if( Archive::isArchive(rootDir) )
+    {
+        clear();
+        if( !d_archive.open(rootDir) )
+            return error(d_archive.getError());
+        d_rootDir = d_archive.getPath();
+        d_store.setArchive(&d_archive);
+        files = d_archive.collectFiles(suffix);
+        content = d_archive.read(files);
+    }else
+        return error("not a directory or archive");
 
-    const QStringList files = collectFiles(dirInfo.absolutePath(),QStringList() << "*.txt" << "*.pas" << "*.inc");
-    const int off = dirInfo.absolutePath().size();
+    const int off = d_rootDir.size();
 
-    foreach( const QString& f, files )
+    for( int i = 0; i < files.size(); i++ )
     {
-        QFile in(f);
+        const QString& f = files[i];
+        QBuffer member;
+        QFile disk(f);
+        QIODevice& in = d_archive.isOpen() ? static_cast<QIODevice&>(member) : disk;
+        if( d_archive.isOpen() )
+        {
+            if( content[i].isNull() )
+                return error(tr("cannot read archive member: %1").arg(f));
+            member.setData(content[i]);
+        }
         if( !in.open(QIODevice::ReadOnly) )
             return error(tr("cannot open file for reading: %1").arg(f));
         QByteArray moduleName;
-        FileType fileType = detectType(&in,&moduleName);
-        if( fileType == UnknownFile )
-            fileType = detectType2(&in,&moduleName);
+        QByteArrayList uses;
+        const FileType fileType = scanHeader(&in,&moduleName,&uses);
         if( fileType == UnknownFile )
             continue;
+        QByteArray hash;
+        if( fileType == PascalProgram || fileType == PascalUnit || fileType == AsmUnit )
+        {
+            // identical modules in different places of the tree are only parsed once, see CodeModel
+            in.reset();
+            const QByteArray data = in.readAll();
+            hash = QCryptographicHash::hash(data,QCryptographicHash::Md5);
+            d_store.put(f,data); // the lexers use it without reading the file again
+        }else if( d_archive.isOpen() )
+            d_store.put(f,content[i]); // already inflated
         in.close();
 
         QFileInfo info(f);
@@ -108,6 +248,14 @@ bool FileSystem::load(const QString& rootDir)
         file->d_name = name;
         file->d_moduleName = moduleName;
         file->d_moduleLc = moduleName.toLower();
+        file->d_uses = uses;
+        file->d_hash = hash;
+        if( d_archive.isOpen() )
+        {
+            file->d_size = content[i].size();
+            if( !d_archive.getCrc(f, &file->d_crc) )
+                file->d_crc = Archive::crc32(content[i].constData(),content[i].size()); // tar has no checksum
+        }
         if( !file->d_moduleLc.isEmpty() )
         {
             File*& slot = d_moduleMap[file->d_moduleLc];
@@ -134,14 +282,14 @@ bool FileSystem::load(const QString& rootDir)
             // file with no dir
             Dir* dir = getDir(relDirPath);
             file->d_dir = dir;
-            dir->d_files.append(file);
+            dir->add(file);
         }else if( parts.size() >= 2 )
         {
             Dir* dir = getDir(replaceLast(relDirPath,parts.front()));
             parts.pop_front();
             file->d_name = parts.join('_');
             file->d_dir = dir;
-            dir->d_files.append(file);
+            dir->add(file);
         }
     }
 
@@ -161,6 +309,7 @@ bool FileSystem::load(const QString& rootDir)
     }
     qDebug() << count;
 #endif
+    setVirtualPaths(&d_root);
     return true;
 }
 
@@ -168,9 +317,7 @@ bool FileSystem::addToRoot(const QStringList& files)
 {
     // used for testing purpose
 
-    d_root.clear();
-    d_fileMap.clear();
-    d_moduleMap.clear();
+    clear();
 
     foreach( const QString& f, files )
     {
@@ -188,8 +335,9 @@ bool FileSystem::addToRoot(const QStringList& files)
         file->d_realPath = f;
         d_fileMap[f] = file;
         file->d_dir = &d_root;
-        d_root.d_files.append(file);
+        d_root.add(file);
     }
+    setVirtualPaths(&d_root);
     return true;
 }
 
@@ -233,6 +381,17 @@ const FileSystem::File*FileSystem::findFile(const QString& realPath) const
 const FileSystem::File*FileSystem::findFile(const Dir* startFrom, const QString& dir, const QString& name) const
 {
     Q_ASSERT(startFrom);
+    const FindKey key(startFrom, dir + '/' + name);
+    {
+        QMutexLocker lock(&d_lock);
+        d_lookups++;
+        QHash<FindKey,const File*>::const_iterator i = d_found.find(key);
+        if( i != d_found.end() )
+        {
+            d_lookupHits++;
+            return i.value();
+        }
+    }
     const File* res = 0;
     const Dir* d = startFrom;
     while( res == 0 && d )
@@ -241,16 +400,14 @@ const FileSystem::File*FileSystem::findFile(const Dir* startFrom, const QString&
             res = d->file(name);
         if( res == 0 && !dir.isEmpty() )
         {
-            for( int i = 0; i < d->d_subdirs.size(); i++ )
-            {
-                if( d->d_subdirs[i]->d_name == dir )
-                    res = d->d_subdirs[i]->file(name);
-                if( res )
-                    break;
-            }
+            const Dir* sub = d->subdir(dir);
+            if( sub )
+                res = sub->file(name);
         }
         d = d->d_dir;
     }
+    QMutexLocker lock(&d_lock);
+    d_found.insert(key,res);
     return res;
 }
 
@@ -287,13 +444,59 @@ const FileSystem::File*FileSystem::findModule(const FileSystem::Dir* startFrom,
     return res;
 }
 
-FileSystem::FileType FileSystem::detectType(QIODevice* in, QByteArray* name)
+static bool readUses(Lexer& lex, QByteArrayList* uses)
+{
+    // lex is positioned behind the module name; returns false if the stream ends before the header
+    Token t = lex.nextToken();
+    while( t.isValid() )
+    {
+        switch( t.d_type )
+        {
+        case Tok_uses:
+            t = lex.nextToken();
+            while( t.isValid() && t.d_type != Tok_Semi )
+            {
+                if( t.d_type == Tok_identifier )
+                {
+                    const QByteArray id = t.d_val;
+                    t = lex.nextToken();
+                    if( t.d_type == Tok_Slash )
+                    {
+                        t = lex.nextToken();
+                        if( t.d_type == Tok_identifier ) // just to make sure
+                        {
+                            uses->append( t.d_val );
+                            t = lex.nextToken();
+                        }
+                    }else
+                        uses->append(id);
+                }else
+                    t = lex.nextToken();
+            }
+            return t.isValid();
+        case Tok_label:
+        case Tok_var:
+        case Tok_const:
+        case Tok_type:
+        case Tok_procedure:
+        case Tok_function:
+        case Tok_implementation:
+            return true;
+        }
+        t = lex.nextToken();
+    }
+    return false;
+}
+
+FileSystem::FileType FileSystem::detectType(QIODevice* in, QByteArray* name, QByteArrayList* uses, bool* complete)
 {
     Q_ASSERT(in);
     in->reset();
     Lexer lex;
     lex.setStream(in);
     lex.setIgnoreComments(false);
+    if( complete )
+        *complete = true;
     Token t = lex.nextToken();
     FileType res = UnknownFile;
     while( t.isValid() )
@@ -305,23 +508,20 @@ FileSystem::FileType FileSystem::detectType(QIODevice* in, QByteArray* name)
                 res = PascalFragment;
             break;
         case Tok_program:
-            if( name )
-            {
-                while( t.d_type != Tok_identifier && t.isValid() )
-                    t = lex.nextToken();
-                if( t.d_type == Tok_identifier )
-                    *name = t.d_val;
-            }
-            return PascalProgram;
         case Tok_unit:
-            if( name )
+            res = t.d_type == Tok_program ? PascalProgram : PascalUnit;
+            while( t.d_type != Tok_identifier && t.isValid() )
+                t = lex.nextToken();
+            if( t.d_type == Tok_identifier && name )
+                *name = t.d_val;
+            if( uses )
             {
-                while( t.d_type != Tok_identifier && t.isValid() )
-                    t = lex.nextToken();
-                if( t.d_type == Tok_identifier )
-                    *name = t.d_val;
+                lex.setIgnoreComments(true);
+                const bool ok = readUses(lex, uses);
+                if( complete )
+                    *complete = ok;
             }
-            return PascalUnit;
+            return res;
         case Tok_function:
         case Tok_procedure:
         case Tok_const:
@@ -336,15 +536,19 @@ FileSystem::FileType FileSystem::detectType(QIODevice* in, QByteArray* name)
 
         t = lex.nextToken();
     }
+    if( complete )
+        *complete = false;
     return res;
 }
 
-FileSystem::FileType FileSystem::detectType2(QIODevice* in, QByteArray* name)
+FileSystem::FileType FileSystem::detectType2(QIODevice* in, QByteArray* name, bool* complete)
 {
     Q_ASSERT(in);
     in->reset();
     Asm::Lexer lex;
     lex.setStream(in);
+    if( complete )
+        *complete = true;
     Asm::Token t = lex.nextToken();
     FileType res = UnknownFile;
     int n = 0;
@@ -360,6 +564,8 @@ FileSystem::FileType FileSystem::detectType2(QIODevice* in, QByteArray* name)
                         t = lex.nextToken();
                     if( t.d_type == Asm::Tok_identifier )
                         *name = t.d_val;
+                    if( complete )
+                        *complete = lex.nextToken().isValid(); // the name might be cut off
                 }
                 return AsmUnit;
             }else if( t.isDirective() )
@@ -372,17 +578,74 @@ FileSystem::FileType FileSystem::detectType2(QIODevice* in, QByteArray* name)
         n++;
         t = lex.nextToken();
     }
+    if( complete && n < 20 )
+        *complete = false;
     if( t.d_type == Asm::Tok_Invalid )
         res = UnknownFile;
     return res;
 }
 
+FileSystem::FileType FileSystem::scanHeader(QIODevice* in, QByteArray* name, QByteArrayList* uses)
+{
+    // Only the first HeaderScanSize bytes are lexed; the whole file is only used if the header
+    // (e.g. a long uses list) goes beyond
+    Q_ASSERT(in);
+    in->reset();
+    QByteArray head = in->read(HeaderScanSize);
+    const bool whole = in->atEnd();
+    if( !whole )
+        head.truncate(head.lastIndexOf('\n') + 1); // otherwise e.g. "progr|am" is taken for an identifier
+    QBuffer buf;
+    buf.setData(head);
+    buf.open(QIODevice::ReadOnly);
+    for( int pass = 0; pass < 2; pass++ )
+    {
+        QIODevice* dev = pass == 0 ? (QIODevice*)&buf : in;
+        bool complete;
+        name->clear();
+        uses->clear();
+        FileType res = detectType(dev,name,uses,&complete);
+        // everything which is not Pascal is checked for assembler, unless the Pascal lexer ran out of
+        // the prefix and the next pass looks at the whole file anyway
+        if( res == UnknownFile && ( complete || whole || pass == 1 ) )
+            res = detectType2(dev,name,&complete);
+        if( complete || whole || pass == 1 )
+            return res;
+    }
+    return UnknownFile;
+}
+
 bool FileSystem::error(const QString& msg)
 {
     d_error = msg;
     return false;
 }
 
+void FileSystem::clear()
+{
+    d_store.clear();
+    d_store.setArchive(0);
+    d_archive.close();
+    d_root.clear();
+    d_fileMap.clear();
+    d_moduleMap.clear();
+    QMutexLocker lock(&d_lock);
+    d_found.clear();
+    d_lookups = 0;
+    d_lookupHits = 0;
+}
+
+void FileSystem::setVirtualPaths(FileSystem::Dir* dir)
+{
+    for( int i = 0; i < dir->d_files.size(); i++ )
+    {
+        dir->d_files[i]->d_virtualPath.clear(); // otherwise getVirtualPath returns it
+        dir->d_files[i]->d_virtualPath = dir->d_files[i]->getVirtualPath();
+    }
+    for( int i = 0; i < dir->d_subdirs.size(); i++ )
+        setVirtualPaths(dir->d_subdirs[i]);
+}
+
 FileSystem::Dir*FileSystem::getDir(const QString& relPath)
 {
     const QStringList segs = relPath.split('/');
@@ -395,8 +658,7 @@ FileSystem::Dir*FileSystem::getDir(const QString& relPath)
         {
             res = new Dir();
             res->d_name = segs[i];
-            cur->d_subdirs.append(res);
-            res->d_dir = cur;
+            cur->add(res);
         }
         cur = res;
     }
@@ -411,6 +673,26 @@ void FileSystem::Dir::clear()
     for( int i = 0; i < d_files.size(); i++ )
         delete d_files[i];
     d_files.clear();
+    d_subdirIdx.clear();
+    d_fileIdx.clear();
+    d_moduleIdx.clear();
+}
+
+void FileSystem::Dir::add(FileSystem::Dir* sub)
+{
+    sub->d_dir = this;
+    d_subdirs.append(sub);
+    if( !d_subdirIdx.contains(sub->d_name) )
+        d_subdirIdx.insert(sub->d_name,sub);
+}
+
+void FileSystem::Dir::add(FileSystem::File* f)
+{
+    d_files.append(f);
+    if( !d_fileIdx.contains(f->d_name) )
+        d_fileIdx.insert(f->d_name,f);
+    if( !d_moduleIdx.contains(f->d_moduleLc) )
+        d_moduleIdx.insert(f->d_moduleLc,f);
 }
 
 static const char* typeName(int t)
@@ -445,30 +727,23 @@ void FileSystem::Dir::dump(int level) const
 
 FileSystem::Dir*FileSystem::Dir::subdir(const QString& name) const
 {
-    for(int i = 0; i < d_subdirs.size(); i++ )
-        if( d_subdirs[i]->d_name == name )
-            return d_subdirs[i];
-    return 0;
+    return d_subdirIdx.value(name);
 }
 
 const FileSystem::File*FileSystem::Dir::file(const QString& name) const
 {
-    for(int i = 0; i < d_files.size(); i++ )
-        if( d_files[i]->d_name == name )
-            return d_files[i];
-    return 0;
+    return d_fileIdx.value(name);
 }
 
 const FileSystem::File*FileSystem::Dir::module(const QByteArray& nameLc) const
 {
-    for(int i = 0; i < d_files.size(); i++ )
-        if( d_files[i]->d_moduleLc == nameLc )
-            return d_files[i];
-    return 0;
+    return d_moduleIdx.value(nameLc);
 }
 
 QString FileSystem::File::getVirtualPath(bool suffix) const
 {
+    if( !d_virtualPath.isEmpty() )
+        return suffix ? d_virtualPath : d_virtualPath.left(d_virtualPath.size() - ::strlen(typeName(d_type)));
     const Dir* d = d_dir;
     QString res;
     while( d && !d->d_name.isEmpty() )
@@ -18,7 +18,11 @@
 */
 
 #include <QHash>
+#include <QMutex>
 #include <QObject>
+#include <QStringList>
+#include "LisaSourceStore.h"
+#include "LisaArchive.h"
 
 class QIODevice;
 
@@ -35,7 +39,13 @@ public:
         QList<File*> d_files;
         QString d_name;
         Dir* d_dir;
+        // first entry by name, as the lists would be searched
+        QHash<QString,Dir*> d_subdirIdx;
+        QHash<QString,File*> d_fileIdx;
+        QHash<QByteArray,File*> d_moduleIdx;
 
+        void add(Dir*);
+        void add(File*);
         void clear();
         void dump(int level = 0) const;
         Dir* subdir(const QString& name) const;
@@ -56,15 +66,19 @@ public:
         QString d_name; // fileName
         QString d_moduleName;
         QByteArray d_moduleLc; // lower-case version
+        QByteArray d_hash; // content hash, only for programs, units and assembler units
+        QByteArrayList d_uses; // the modules in the uses clause, only for programs and units
+        quint32 d_size, d_crc; // of the raw content, only for archive members (identity for IncludeCache)
         Dir* d_dir;
+        QString d_virtualPath; // with suffix, set when the file system is loaded
         QString getVirtualPath(bool suffix = true) const;
         int level() const;
 
-        File():d_doublette(false),d_type(UnknownFile),d_dir(0),d_forceParse(false),d_parsed(false){}
+        File():d_doublette(false),d_type(UnknownFile),d_size(0),d_crc(0),d_dir(0),d_forceParse(false),d_parsed(false){}
     };
 
     explicit FileSystem(QObject *parent = 0);
-    bool load( const QString& rootDir );
+    bool load( const QString& rootDir ); // a directory or a zip, tar or tar.gz archive
     bool addToRoot( const QStringList& files );
     const QString& getError() const { return d_error; }
     const Dir& getRoot() const { return d_root; }
@@ -74,19 +88,34 @@ public:
     const File* findFile(const QString& realPath) const;
     const File* findFile(const Dir* startFrom, const QString& dir, const QString& name) const;
     const File* findModule(const Dir* startFrom, const QByteArray& nameLc) const;
+    SourceStore* getStore() { return &d_store; }
+    bool isArchive() const { return d_archive.isOpen(); } // the real paths are virtual, see Archive
+    quint32 getLookups() const { return d_lookups; }
+    quint32 getLookupHits() const { return d_lookupHits; }
 
-    static FileType detectType(QIODevice* in, QByteArray* = 0);
-    static FileType detectType2(QIODevice* in, QByteArray* = 0);
+    static QStringList collectFiles(const QString& dir, const QStringList& suffix);
+    enum { HeaderScanSize = 4096 };
+    static FileType scanHeader(QIODevice* in, QByteArray* name, QByteArrayList* uses);
+    static FileType detectType(QIODevice* in, QByteArray* = 0, QByteArrayList* uses = 0, bool* complete = 0);
+    static FileType detectType2(QIODevice* in, QByteArray* = 0, bool* complete = 0);
 protected:
     bool error( const QString& );
     Dir* getDir( const QString& relPath );
+    void clear();
+    void setVirtualPaths(Dir*);
 
 private:
     QString d_rootDir;
     QString d_error;
     Dir d_root;
+    SourceStore d_store;
+    Archive d_archive;
     QHash<QString,File*> d_fileMap;
     QHash<QByteArray,File*> d_moduleMap; // module to File* is ambig, but besides "prmgr" (nearly) identical
+    typedef QPair<const Dir*,QString> FindKey; // start dir, dir + '/' + name
+    mutable QHash<FindKey,const File*> d_found; // memoized findFile results
+    mutable QMutex d_lock; // findFile is used by the lexers of parallel parsers
+    mutable quint32 d_lookups, d_lookupHits;
 };
 }
 
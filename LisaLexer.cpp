@@ -17,11 +17,13 @@
 #include "LisaLexer.h"
 #include <QBuffer>
 #include <QtDebug>
+#include <algorithm>
 using namespace Lisa;
 
 Lexer::Lexer():
     d_lastToken(Tok_Invalid),d_lineNr(0),d_colNr(0),d_in(0),
-    d_ignoreComments(true), d_packComments(true),d_sloc(0),d_lineCounted(false)
+    d_ignoreComments(true), d_packComments(true),d_sloc(0),d_lineCounted(false),
+    d_inComment(0),d_resumeComment(0),d_interval(0)
 {
 
 }
@@ -39,6 +41,40 @@ void Lexer::setStream(QIODevice* in, const QString& filePath)
     d_filePath = filePath;
     d_sloc = 0;
     d_lineCounted = false;
+    d_inComment = 0;
+    d_resumeComment = 0;
+    d_checkpoints.clear();
+}
+
+static bool CheckpointLessThan( quint32 lineNr, const Lexer::Checkpoint& cp )
+{
+    return lineNr < cp.d_lineNr;
+}
+
+int Lexer::findCheckpoint(quint32 lineNr) const
+{
+    QList<Checkpoint>::const_iterator i = std::upper_bound(d_checkpoints.begin(), d_checkpoints.end(),
+                                                           lineNr, CheckpointLessThan);
+    return int(i - d_checkpoints.begin()) - 1;
+}
+
+bool Lexer::resume(const Lexer::Checkpoint& cp)
+{
+    if( d_in == 0 || d_in->isSequential() || !d_in->seek(cp.d_offset) )
+        return false;
+    d_lineNr = cp.d_lineNr - 1;
+    d_colNr = 0;
+    d_line.clear();
+    d_buffer.clear();
+    d_lastToken = Tok_Invalid;
+    d_sloc = cp.d_sloc;
+    d_lineCounted = false;
+    d_inComment = 0;
+    d_resumeComment = cp.d_comment;
+    // checkpoints after this one are recorded again while lexing
+    while( !d_checkpoints.isEmpty() && d_checkpoints.last().d_lineNr >= cp.d_lineNr )
+        d_checkpoints.pop_back();
+    return true;
 }
 
 Token Lexer::nextToken()
@@ -85,10 +121,89 @@ QList<Token> Lexer::tokens(const QString& code)
     return res;
 }
 
+void Lexer::skipToComment()
+{
+    while( !d_buffer.isEmpty() )
+    {
+        if( d_buffer.first().d_type == Tok_Comment || d_buffer.first().d_type == Tok_Eof )
+            return;
+        d_buffer.pop_front();
+    }
+    if( d_in == 0 )
+        return;
+    // Only line, column and string boundaries are tracked; no tokens are created, but a line
+    // is counted in sloc exactly when nextToken() would deliver a valid token on it.
+    while( true )
+    {
+        while( d_colNr < d_line.size() )
+        {
+            const char ch = d_line[d_colNr];
+            if( ch == '{' || ( ch == '(' && lookAhead() == '*' ) )
+                return;
+            if( ::isspace(ch) || ch == char(0xff) )
+                d_colNr++;
+            else if( ch == '\'' )
+            {
+                int off = 1;
+                while( true )
+                {
+                    const char c = lookAhead(off);
+                    off++;
+                    if( c == '\'' )
+                    {
+                        if( lookAhead(off) == '\'' )
+                            off++;
+                        else
+                        {
+                            countLine();
+                            break;
+                        }
+                    }
+                    if( c == 0 )
+                        break; // non-terminated string
+                }
+                d_colNr += off;
+            }else if( ::isalpha(ch) || ch == '%' || ch == '_' || ch == '$' )
+            {
+                countLine();
+                int off = 1;
+                while( ::isalnum(lookAhead(off)) || lookAhead(off) == '_' || lookAhead(off) == '%' )
+                    off++;
+                d_colNr += off;
+            }else if( ::isdigit(ch) )
+                number(); // rare enough and takes care of invalid reals
+            else
+            {
+                int pos = d_colNr;
+                const TokenType tt = tokenTypeFromString(d_line,&pos);
+                if( tt == Tok_Invalid || pos == d_colNr )
+                    d_colNr++;
+                else
+                {
+                    countLine();
+                    d_colNr = pos;
+                }
+            }
+        }
+        if( d_in->atEnd() )
+            return;
+        nextLine();
+    }
+}
+
 Token Lexer::nextTokenImp()
 {
     if( d_in == 0 )
         return token(Tok_Eof);
+    if( d_resumeComment && !d_in->atEnd() )
+    {
+        // the line following the checkpoint is the continuation of a comment
+        const bool brace = d_resumeComment == 1;
+        d_resumeComment = 0;
+        nextLine();
+        return comment(brace);
+    }
+    d_resumeComment = 0;
     skipWhiteSpace();
 
     while( d_colNr >= d_line.size() )
@@ -146,6 +261,16 @@ int Lexer::skipWhiteSpace()
 
 void Lexer::nextLine()
 {
+    if( d_interval && d_lineNr % d_interval == 0 )
+    {
+        Checkpoint cp;
+        cp.d_lineNr = d_lineNr + 1;
+        cp.d_offset = d_in->pos();
+        cp.d_sloc = d_sloc;
+        cp.d_comment = d_inComment;
+        if( d_checkpoints.isEmpty() || d_checkpoints.last().d_lineNr < cp.d_lineNr )
+            d_checkpoints.append(cp);
+    }
     d_colNr = 0;
     d_lineNr++;
     d_line = d_in->readLine();
@@ -312,6 +437,7 @@ Token Lexer::comment(bool brace)
         pos += tag.size();
         str = d_line.mid(d_colNr,pos-d_colNr);
     }
+    d_inComment = brace ? 1 : 2;
     while( !terminated && !d_in->atEnd() )
     {
         nextLine();
@@ -327,6 +453,7 @@ Token Lexer::comment(bool brace)
             str += d_line.mid(d_colNr,pos-d_colNr);
         }
     }
+    d_inComment = 0;
     if( d_packComments && !terminated && d_in->atEnd() )
     {
         d_colNr = d_line.size();
@@ -27,6 +27,14 @@ namespace Lisa
 class Lexer
 {
 public:
+    struct Checkpoint
+    {
+        quint32 d_lineNr; // the line which starts at d_offset
+        qint64 d_offset;
+        quint32 d_sloc; // before d_lineNr
+        quint8 d_comment; // 0: none, 1: d_lineNr continues a { comment, 2: continues a (* comment
+    };
+
     Lexer();
     ~Lexer();
 
@@ -38,7 +46,13 @@ public:
     Token nextToken();
     Token peekToken(quint8 lookAhead = 1);
     QList<Token> tokens( const QString& code );
+    void skipToComment(); // skip raw source up to the next comment or eof, e.g. in muted regions
     quint32 getSloc() const { return d_sloc; }
+
+    void setCheckpointInterval( quint16 lines ) { d_interval = lines; } // 0 means no checkpoints
+    const QList<Checkpoint>& getCheckpoints() const { return d_checkpoints; }
+    int findCheckpoint( quint32 lineNr ) const; // the last checkpoint at or before lineNr, or -1
+    bool resume( const Checkpoint& ); // the device must be seekable; tokens continue from the checkpoint
 protected:
     Token nextTokenImp();
     int skipWhiteSpace();
@@ -63,6 +77,10 @@ private:
     bool d_ignoreComments;  // don't deliver comment tokens
     bool d_packComments;    // Only deliver one Tok_Comment for /**/ instead of Tok_Lcmt and Tok_Rcmt
     bool d_lineCounted;
+    quint8 d_inComment; // while reading the lines of a multi-line comment
+    quint8 d_resumeComment;
+    quint16 d_interval;
+    QList<Checkpoint> d_checkpoints;
 };
 
 }
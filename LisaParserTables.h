@@ -0,0 +1,1519 @@
+// This file was automatically generated by syntax/ParserTables.py from LisaParser.cpp; don't modify it!
+
+static const char* const s_names[] = {
+	"LisaPascal",
+	"program_",
+	"program_heading",
+	"uses_clause",
+	"identifier_list2",
+	"regular_unit",
+	"unit_heading",
+	"interface_part",
+	"implementation_part",
+	"non_regular_unit",
+	"block",
+	"label_declaration_part",
+	"label_",
+	"constant_declaration_part",
+	"constant_declaration",
+	"constant",
+	"type_declaration_part",
+	"type_declaration",
+	"variable_declaration_part",
+	"variable_declaration",
+	"procedure_and_function_interface_part",
+	"procedure_and_function_declaration_part",
+	"subroutine_part",
+	"method_block",
+	"procedure_declaration",
+	"body_",
+	"function_declaration",
+	"procedure_heading",
+	"function_heading",
+	"formal_parameter_list",
+	"formal_parameter_section",
+	"parameter_declaration",
+	"statement_sequence",
+	"statement",
+	"simple_statement",
+	"assigOrCall",
+	"goto_statement",
+	"structured_statement",
+	"compound_statement",
+	"repetitive_statement",
+	"while_statement",
+	"repeat_statement",
+	"for_statement",
+	"conditional_statement",
+	"if_statement",
+	"case_statement",
+	"case_limb",
+	"case_label_list",
+	"otherwise_clause",
+	"with_statement",
+	"actual_parameter_list",
+	"factor",
+	"relational_operator",
+	"addition_operator",
+	"multiplication_operator",
+	"variable_reference",
+	"qualifier",
+	"index",
+	"field_designator",
+	"dereferencer",
+	"set_literal",
+	"member_group",
+	"type_",
+	"simple_type",
+	"string_type",
+	"size_attribute",
+	"enumerated_type",
+	"subrange_type",
+	"structured_type",
+	"array_type",
+	"set_type",
+	"file_type",
+	"pointer_type",
+	"class_type",
+	"method_interface",
+	"record_type",
+	"field_list",
+	"fixed_part",
+	"field_declaration",
+	"variant_part",
+	"tag_field",
+	"variant",
+	"field_identifier",
+	"variable_identifier",
+	"type_identifier",
+	"identifier_list",
+	"expression_list",
+	"unsigned_integer",
+	"unsigned_number",
+	"sign",
+};
+// token sets, each terminated by SetEnd
+static const quint16 s_sets[] = {
+	Tok_program, SetEnd,
+	Tok_unit, SetEnd,
+	Tok_begin, Tok_end, Tok_function, Tok_procedure, SetEnd,
+	Tok_uses, SetEnd,
+	Tok_begin, SetEnd,
+	Tok_Lpar, SetEnd,
+	Tok_Slash, SetEnd,
+	Tok_Comma, SetEnd,
+	Tok_intrinsic, SetEnd,
+	Tok_shared, SetEnd,
+	Tok_end, SetEnd,
+	Tok_const, Tok_function, Tok_procedure, Tok_type, Tok_var, SetEnd,
+	Tok_const, SetEnd,
+	Tok_type, SetEnd,
+	Tok_var, SetEnd,
+	Tok_const, Tok_function, Tok_implementation, Tok_procedure, Tok_type, Tok_var, SetEnd,
+	Tok_const, Tok_function, Tok_methods, Tok_procedure, Tok_type, Tok_var, SetEnd,
+	Tok_const, Tok_end, Tok_function, Tok_methods, Tok_procedure, Tok_type, Tok_var, SetEnd,
+	Tok_function, Tok_procedure, SetEnd,
+	Tok_begin, Tok_end, SetEnd,
+	Tok_const, Tok_function, Tok_label, Tok_procedure, Tok_type, Tok_var, SetEnd,
+	Tok_label, SetEnd,
+	Tok_begin, Tok_const, Tok_end, Tok_function, Tok_label, Tok_procedure, Tok_type, Tok_var, SetEnd,
+	Tok_identifier, SetEnd,
+	Tok_Semi, SetEnd,
+	Tok_Minus, Tok_Plus, Tok_digit_sequence, Tok_hex_digit_sequence, Tok_identifier, Tok_unsigned_real, SetEnd,
+	Tok_Minus, Tok_Plus, SetEnd,
+	Tok_digit_sequence, Tok_hex_digit_sequence, Tok_unsigned_real, SetEnd,
+	Tok_string_literal, SetEnd,
+	Tok_procedure, SetEnd,
+	Tok_function, SetEnd,
+	Tok_function, Tok_methods, Tok_procedure, SetEnd,
+	Tok_methods, SetEnd,
+	Tok_begin, Tok_const, Tok_function, Tok_label, Tok_procedure, Tok_type, Tok_var, SetEnd,
+	Tok_forward, SetEnd,
+	Tok_external, SetEnd,
+	Tok_inline, SetEnd,
+	Tok_Dot, SetEnd,
+	Tok_Colon, SetEnd,
+	Tok_Semi, Tok_function, Tok_identifier, Tok_procedure, Tok_var, SetEnd,
+	Tok_identifier, Tok_var, SetEnd,
+	Tok_digit_sequence, SetEnd,
+	Tok_Semi, Tok_else, Tok_end, Tok_goto, Tok_identifier, Tok_otherwise, Tok_until, SetEnd,
+	Tok_goto, Tok_identifier, SetEnd,
+	Tok_begin, Tok_case, Tok_for, Tok_if, Tok_repeat, Tok_while, Tok_with, SetEnd,
+	Tok_goto, SetEnd,
+	Tok_ColonEq, SetEnd,
+	Tok_for, Tok_repeat, Tok_while, SetEnd,
+	Tok_case, Tok_if, SetEnd,
+	Tok_with, SetEnd,
+	Tok_while, SetEnd,
+	Tok_repeat, SetEnd,
+	Tok_for, SetEnd,
+	Tok_to, SetEnd,
+	Tok_downto, SetEnd,
+	Tok_if, SetEnd,
+	Tok_case, SetEnd,
+	Tok_else, SetEnd,
+	Tok_Minus, Tok_Plus, Tok_digit_sequence, Tok_hex_digit_sequence, Tok_identifier, Tok_string_literal, Tok_unsigned_real, SetEnd,
+	Tok_otherwise, SetEnd,
+	Tok_Semi, Tok_otherwise, SetEnd,
+	Tok_begin, Tok_case, Tok_digit_sequence, Tok_for, Tok_goto, Tok_identifier, Tok_if, Tok_otherwise, Tok_repeat, Tok_while, Tok_with, SetEnd,
+	Tok_Eq, Tok_Geq, Tok_Gt, Tok_Leq, Tok_Lt, Tok_LtGt, Tok_in, SetEnd,
+	Tok_Minus, Tok_Plus, Tok_or, SetEnd,
+	Tok_Colon, Tok_Slash, Tok_Star, Tok_and, Tok_div, Tok_mod, SetEnd,
+	Tok_At, SetEnd,
+	Tok_Dot, Tok_Hat, Tok_Lbrack, Tok_Lpar, SetEnd,
+	Tok_Dot, Tok_Hat, Tok_Lbrack, SetEnd,
+	Tok_nil, SetEnd,
+	Tok_Lbrack, SetEnd,
+	Tok_not, SetEnd,
+	Tok_Eq, SetEnd,
+	Tok_LtGt, SetEnd,
+	Tok_Lt, SetEnd,
+	Tok_Leq, SetEnd,
+	Tok_Gt, SetEnd,
+	Tok_Geq, SetEnd,
+	Tok_in, SetEnd,
+	Tok_Plus, SetEnd,
+	Tok_Minus, SetEnd,
+	Tok_or, SetEnd,
+	Tok_Star, SetEnd,
+	Tok_div, SetEnd,
+	Tok_mod, SetEnd,
+	Tok_and, SetEnd,
+	Tok_Hat, SetEnd,
+	Tok_At, Tok_Lbrack, Tok_Lpar, Tok_Minus, Tok_Plus, Tok_digit_sequence, Tok_hex_digit_sequence, Tok_identifier, Tok_nil, Tok_not, Tok_string_literal, Tok_unsigned_real, SetEnd,
+	Tok_2Dot, SetEnd,
+	Tok_Lpar, Tok_Minus, Tok_Plus, Tok_digit_sequence, Tok_hex_digit_sequence, Tok_identifier, Tok_string_literal, Tok_unsigned_real, SetEnd,
+	Tok_string, SetEnd,
+	Tok_array, Tok_file, Tok_packed, Tok_record, Tok_set, Tok_subclass, SetEnd,
+	Tok_digit_sequence, Tok_hex_digit_sequence, SetEnd,
+	Tok_packed, SetEnd,
+	Tok_array, SetEnd,
+	Tok_record, SetEnd,
+	Tok_set, SetEnd,
+	Tok_file, SetEnd,
+	Tok_subclass, SetEnd,
+	Tok_of, SetEnd,
+	Tok_case, Tok_identifier, SetEnd,
+	Tok_Rpar, Tok_end, SetEnd,
+	Tok_hex_digit_sequence, SetEnd,
+	Tok_unsigned_real, SetEnd,
+};
+enum { SetCount = 103 };
+
+static const quint16 s_conds[] = {
+	CondIn, 1, 0, CondEnd,
+	CondIn, 1, 1, CondEnd,
+	CondIn, 1, 2, CondEnd,
+	CondIn, 1, 3, CondEnd,
+	CondIn, 1, 4, CondEnd,
+	CondIn, 1, 5, CondEnd,
+	CondIn, 1, 6, CondEnd,
+	CondIn, 1, 7, CondEnd,
+	CondIn, 1, 8, CondEnd,
+	CondIn, 1, 9, CondEnd,
+	CondIn, 1, 10, CondEnd,
+	CondIn, 1, 11, CondEnd,
+	CondIn, 1, 12, CondEnd,
+	CondIn, 1, 13, CondEnd,
+	CondIn, 1, 14, CondEnd,
+	CondIn, 1, 15, CondEnd,
+	CondIn, 1, 16, CondEnd,
+	CondIn, 1, 17, CondEnd,
+	CondIn, 1, 18, CondEnd,
+	CondIn, 1, 19, CondEnd,
+	CondIn, 1, 20, CondEnd,
+	CondIn, 1, 21, CondEnd,
+	CondIn, 1, 22, CondEnd,
+	CondIn, 1, 23, CondEnd,
+	CondIn, 1, 24, CondEnd,
+	CondIn, 1, 25, CondEnd,
+	CondIn, 1, 26, CondEnd,
+	CondIn, 1, 27, CondEnd,
+	CondIn, 1, 28, CondEnd,
+	CondIn, 1, 29, CondEnd,
+	CondIn, 1, 30, CondEnd,
+	CondIn, 1, 31, CondEnd,
+	CondIn, 1, 32, CondEnd,
+	CondIn, 1, 33, CondEnd,
+	CondIn, 1, 34, CondEnd,
+	CondIn, 1, 35, CondEnd,
+	CondIn, 1, 36, CondEnd,
+	CondIn, 1, 37, CondEnd,
+	CondIn, 1, 38, CondEnd,
+	CondIn, 1, 39, CondEnd,
+	CondIn, 1, 40, CondEnd,
+	CondIn, 1, 41, CondEnd,
+	CondIn, 1, 42, CondEnd,
+	CondIn, 1, 43, CondEnd,
+	CondIn, 1, 44, CondEnd,
+	CondIn, 1, 45, CondEnd,
+	CondIn, 1, 46, CondEnd,
+	CondIn, 1, 47, CondEnd,
+	CondIn, 1, 48, CondEnd,
+	CondIn, 1, 49, CondEnd,
+	CondIn, 1, 50, CondEnd,
+	CondIn, 1, 51, CondEnd,
+	CondIn, 1, 52, CondEnd,
+	CondIn, 1, 53, CondEnd,
+	CondIn, 1, 54, CondEnd,
+	CondIn, 1, 55, CondEnd,
+	CondIn, 1, 56, CondEnd,
+	CondIn, 1, 57, CondEnd,
+	CondIn, 1, 58, CondEnd,
+	CondIn, 1, 24, CondIn, 2, 10, CondNot, CondAnd, CondIn, 2, 59, CondNot, CondAnd, CondEnd,
+	CondIn, 1, 60, CondIn, 2, 61, CondAnd, CondEnd,
+	CondIn, 1, 62, CondEnd,
+	CondIn, 1, 63, CondEnd,
+	CondIn, 1, 64, CondEnd,
+	CondIn, 1, 65, CondEnd,
+	CondIn, 1, 66, CondEnd,
+	CondIn, 1, 67, CondEnd,
+	CondIn, 1, 68, CondEnd,
+	CondIn, 1, 69, CondEnd,
+	CondIn, 1, 70, CondEnd,
+	CondIn, 1, 71, CondEnd,
+	CondIn, 1, 72, CondEnd,
+	CondIn, 1, 73, CondEnd,
+	CondIn, 1, 74, CondEnd,
+	CondIn, 1, 75, CondEnd,
+	CondIn, 1, 76, CondEnd,
+	CondIn, 1, 77, CondEnd,
+	CondIn, 1, 78, CondEnd,
+	CondIn, 1, 79, CondEnd,
+	CondIn, 1, 80, CondEnd,
+	CondIn, 1, 81, CondEnd,
+	CondIn, 1, 82, CondEnd,
+	CondIn, 1, 83, CondEnd,
+	CondIn, 1, 84, CondEnd,
+	CondIn, 1, 85, CondEnd,
+	CondIn, 1, 86, CondEnd,
+	CondIn, 1, 87, CondEnd,
+	CondIn, 1, 88, CondEnd,
+	CondIn, 1, 89, CondEnd,
+	CondIn, 1, 90, CondEnd,
+	CondIn, 1, 23, CondIn, 2, 87, CondNot, CondAnd, CondEnd,
+	CondIn, 1, 91, CondEnd,
+	CondIn, 1, 92, CondEnd,
+	CondIn, 1, 93, CondEnd,
+	CondIn, 1, 94, CondEnd,
+	CondIn, 1, 95, CondEnd,
+	CondIn, 1, 96, CondEnd,
+	CondIn, 1, 97, CondEnd,
+	CondIn, 1, 98, CondEnd,
+	CondIn, 1, 99, CondEnd,
+	CondIn, 1, 24, CondIn, 2, 23, CondAnd, CondEnd,
+	CondIn, 1, 24, CondIn, 2, 56, CondAnd, CondEnd,
+	CondIn, 1, 23, CondIn, 2, 38, CondAnd, CondEnd,
+	CondIn, 1, 24, CondIn, 2, 100, CondNot, CondAnd, CondEnd,
+	CondIn, 1, 101, CondEnd,
+	CondIn, 1, 102, CondEnd,
+};
+static const quint16 s_condStart[] = { 0, 4, 8, 12, 16, 20, 24, 28, 32, 36, 40, 44, 48, 52, 56, 60, 64, 68, 72, 76, 80, 84, 88, 92, 96, 100, 104, 108, 112, 116, 120, 124, 128, 132, 136, 140, 144, 148, 152, 156, 160, 164, 168, 172, 176, 180, 184, 188, 192, 196, 200, 204, 208, 212, 216, 220, 224, 228, 232, 236, 250, 258, 262, 266, 270, 274, 278, 282, 286, 290, 294, 298, 302, 306, 310, 314, 318, 322, 326, 330, 334, 338, 342, 346, 350, 354, 358, 362, 366, 370, 374, 383, 387, 391, 395, 399, 403, 407, 411, 415, 419, 427, 435, 443, 452, 456 };
+
+// start address of each rule, by the type of the node it creates
+static const quint16 s_rules[] = {
+	SynTree::R_LisaPascal, 0,
+	SynTree::R_program_, 26,
+	SynTree::R_program_heading, 55,
+	SynTree::R_program_parameters, 81,
+	SynTree::R_uses_clause, 86,
+	SynTree::R_identifier_list2, 99,
+	SynTree::R_regular_unit, 145,
+	SynTree::R_unit_heading, 193,
+	SynTree::R_interface_part, 204,
+	SynTree::R_implementation_part, 253,
+	SynTree::R_non_regular_unit, 295,
+	SynTree::R_block, 336,
+	SynTree::R_label_declaration_part, 381,
+	SynTree::R_label_, 405,
+	SynTree::R_constant_declaration_part, 412,
+	SynTree::R_constant_declaration, 428,
+	SynTree::R_constant, 450,
+	SynTree::R_type_declaration_part, 501,
+	SynTree::R_type_declaration, 517,
+	SynTree::R_variable_declaration_part, 534,
+	SynTree::R_variable_declaration, 550,
+	SynTree::R_procedure_and_function_interface_part, 565,
+	SynTree::R_procedure_and_function_declaration_part, 597,
+	SynTree::R_subroutine_part, 621,
+	SynTree::R_method_block, 652,
+	SynTree::R_procedure_declaration, 710,
+	SynTree::R_body_, 725,
+	SynTree::R_function_declaration, 768,
+	SynTree::R_statement_part, 783,
+	SynTree::R_procedure_heading, 788,
+	SynTree::R_function_heading, 819,
+	SynTree::R_result_type, 861,
+	SynTree::R_formal_parameter_list, 866,
+	SynTree::R_formal_parameter_section, 895,
+	SynTree::R_parameter_declaration, 921,
+	SynTree::R_statement_sequence, 941,
+	SynTree::R_statement, 957,
+	SynTree::R_simple_statement, 992,
+	SynTree::R_assigOrCall, 1011,
+	SynTree::R_goto_statement, 1027,
+	SynTree::R_structured_statement, 1036,
+	SynTree::R_compound_statement, 1069,
+	SynTree::R_repetitive_statement, 1082,
+	SynTree::R_while_statement, 1108,
+	SynTree::R_repeat_statement, 1123,
+	SynTree::R_for_statement, 1138,
+	SynTree::R_initial_value, 1181,
+	SynTree::R_final_value, 1186,
+	SynTree::R_conditional_statement, 1191,
+	SynTree::R_if_statement, 1210,
+	SynTree::R_case_statement, 1236,
+	SynTree::R_case_limb, 1292,
+	SynTree::R_case_label_list, 1303,
+	SynTree::R_otherwise_clause, 1319,
+	SynTree::R_with_statement, 1337,
+	SynTree::R_actual_parameter_list, 1363,
+	SynTree::R_actual_parameter, 1387,
+	SynTree::R_expression, 1392,
+	SynTree::R_simple_expression, 1406,
+	SynTree::R_term, 1427,
+	SynTree::R_factor, 1441,
+	SynTree::R_relational_operator, 1545,
+	SynTree::R_addition_operator, 1613,
+	SynTree::R_multiplication_operator, 1645,
+	SynTree::R_variable_reference, 1704,
+	SynTree::R_qualifier, 1730,
+	SynTree::R_index, 1756,
+	SynTree::R_field_designator, 1769,
+	SynTree::R_dereferencer, 1778,
+	SynTree::R_set_literal, 1785,
+	SynTree::R_member_group, 1814,
+	SynTree::R_type_, 1830,
+	SynTree::R_simple_type, 1863,
+	SynTree::R_ordinal_type, 1891,
+	SynTree::R_string_type, 1896,
+	SynTree::R_size_attribute, 1913,
+	SynTree::R_enumerated_type, 1934,
+	SynTree::R_subrange_type, 1947,
+	SynTree::R_structured_type, 1974,
+	SynTree::R_array_type, 2023,
+	SynTree::R_index_type, 2057,
+	SynTree::R_set_type, 2062,
+	SynTree::R_file_type, 2075,
+	SynTree::R_pointer_type, 2093,
+	SynTree::R_class_type, 2102,
+	SynTree::R_method_interface, 2151,
+	SynTree::R_record_type, 2187,
+	SynTree::R_field_list, 2205,
+	SynTree::R_fixed_part, 2244,
+	SynTree::R_field_declaration, 2260,
+	SynTree::R_variant_part, 2271,
+	SynTree::R_tag_field, 2304,
+	SynTree::R_variant, 2315,
+	SynTree::R_field_identifier, 2339,
+	SynTree::R_variable_identifier, 2346,
+	SynTree::R_type_identifier, 2353,
+	SynTree::R_identifier_list, 2360,
+	SynTree::R_expression_list, 2380,
+	SynTree::R_unsigned_integer, 2396,
+	SynTree::R_unsigned_number, 2419,
+	SynTree::R_sign, 2440,
+};
+enum { RuleCount = 101 };
+
+static const quint16 s_code[] = {
+	// 0: LisaPascal
+	OpNode, SynTree::R_LisaPascal,
+	OpJumpIfNot, 0, 9,
+	OpCall, 26,
+	OpJump, 25,
+	OpJumpIfNot, 1, 16,
+	OpCall, 145,
+	OpJump, 25,
+	OpJumpIfNot, 2, 23,
+	OpCall, 295,
+	OpJump, 25,
+	OpInvalid, 0,
+	OpRet,
+	// 26: program_
+	OpNode, SynTree::R_program_,
+	OpCall, 55,
+	OpExpect, Tok_Semi, 0, 1,
+	OpJumpIfNot, 3, 41,
+	OpCall, 86,
+	OpJump, 41,
+	OpCall, 336,
+	OpJumpIfNot, 4, 54,
+	OpCall, 783,
+	OpExpect, Tok_Dot, 0, 1,
+	OpJump, 54,
+	OpRet,
+	// 55: program_heading
+	OpNode, SynTree::R_program_heading,
+	OpExpect, Tok_program, 0, 2,
+	OpExpect, Tok_identifier, 0, 2,
+	OpJumpIfNot, 5, 80,
+	OpExpect, Tok_Lpar, 0, 2,
+	OpCall, 81,
+	OpExpect, Tok_Rpar, 0, 2,
+	OpJump, 80,
+	OpRet,
+	// 81: program_parameters
+	OpNode, SynTree::R_program_parameters,
+	OpCall, 2360,
+	OpRet,
+	// 86: uses_clause
+	OpNode, SynTree::R_uses_clause,
+	OpExpect, Tok_uses, 0, 3,
+	OpCall, 99,
+	OpExpect, Tok_Semi, 0, 3,
+	OpRet,
+	// 99: identifier_list2
+	OpNode, SynTree::R_identifier_list2,
+	OpExpect, Tok_identifier, 0, 4,
+	OpJumpIfNot, 6, 118,
+	OpExpect, Tok_Slash, 0, 4,
+	OpExpect, Tok_identifier, 0, 4,
+	OpJump, 118,
+	OpJumpIfNot, 7, 144,
+	OpExpect, Tok_Comma, 0, 4,
+	OpExpect, Tok_identifier, 0, 4,
+	OpJumpIfNot, 6, 142,
+	OpExpect, Tok_Slash, 0, 4,
+	OpExpect, Tok_identifier, 0, 4,
+	OpJump, 142,
+	OpJump, 118,
+	OpRet,
+	// 145: regular_unit
+	OpNode, SynTree::R_regular_unit,
+	OpCall, 193,
+	OpExpect, Tok_Semi, 0, 5,
+	OpJumpIfNot, 8, 175,
+	OpExpect, Tok_intrinsic, 0, 5,
+	OpJumpIfNot, 9, 169,
+	OpExpect, Tok_shared, 0, 5,
+	OpJump, 169,
+	OpExpect, Tok_Semi, 0, 5,
+	OpJump, 175,
+	OpCall, 204,
+	OpCall, 253,
+	OpJumpIfNot, 10, 192,
+	OpExpect, Tok_end, 0, 5,
+	OpExpect, Tok_Dot, 0, 5,
+	OpJump, 192,
+	OpRet,
+	// 193: unit_heading
+	OpNode, SynTree::R_unit_heading,
+	OpExpect, Tok_unit, 0, 6,
+	OpExpect, Tok_identifier, 0, 6,
+	OpRet,
+	// 204: interface_part
+	OpNode, SynTree::R_interface_part,
+	OpExpect, Tok_interface, 0, 7,
+	OpJumpIfNot, 3, 217,
+	OpCall, 86,
+	OpJump, 217,
+	OpJumpIfNot, 11, 252,
+	OpJumpIfNot, 12, 227,
+	OpCall, 412,
+	OpJump, 250,
+	OpJumpIfNot, 13, 234,
+	OpCall, 501,
+	OpJump, 250,
+	OpJumpIfNot, 14, 241,
+	OpCall, 534,
+	OpJump, 250,
+	OpJumpIfNot, 15, 248,
+	OpCall, 565,
+	OpJump, 250,
+	OpInvalid, 7,
+	OpJump, 217,
+	OpRet,
+	// 253: implementation_part
+	OpNode, SynTree::R_implementation_part,
+	OpExpect, Tok_implementation, 0, 8,
+	OpJumpIfNot, 16, 294,
+	OpJumpIfNot, 12, 269,
+	OpCall, 412,
+	OpJump, 292,
+	OpJumpIfNot, 13, 276,
+	OpCall, 501,
+	OpJump, 292,
+	OpJumpIfNot, 14, 283,
+	OpCall, 534,
+	OpJump, 292,
+	OpJumpIfNot, 17, 290,
+	OpCall, 621,
+	OpJump, 292,
+	OpInvalid, 8,
+	OpJump, 259,
+	OpRet,
+	// 295: non_regular_unit
+	OpNode, SynTree::R_non_regular_unit,
+	OpJumpIfNot, 18, 304,
+	OpCall, 597,
+	OpJump, 297,
+	OpJumpIfNot, 19, 335,
+	OpJumpIfNot, 4, 318,
+	OpCall, 783,
+	OpExpect, Tok_Dot, 0, 9,
+	OpJump, 333,
+	OpJumpIfNot, 10, 331,
+	OpExpect, Tok_end, 0, 9,
+	OpExpect, Tok_Dot, 0, 9,
+	OpJump, 333,
+	OpInvalid, 9,
+	OpJump, 335,
+	OpRet,
+	// 336: block
+	OpNode, SynTree::R_block,
+	OpJumpIfNot, 20, 380,
+	OpJumpIfNot, 21, 348,
+	OpCall, 381,
+	OpJump, 378,
+	OpJumpIfNot, 12, 355,
+	OpCall, 412,
+	OpJump, 378,
+	OpJumpIfNot, 13, 362,
+	OpCall, 501,
+	OpJump, 378,
+	OpJumpIfNot, 14, 369,
+	OpCall, 534,
+	OpJump, 378,
+	OpJumpIfNot, 22, 376,
+	OpCall, 597,
+	OpJump, 378,
+	OpInvalid, 10,
+	OpJump, 338,
+	OpRet,
+	// 381: label_declaration_part
+	OpNode, SynTree::R_label_declaration_part,
+	OpExpect, Tok_label, 0, 11,
+	OpCall, 405,
+	OpJumpIfNot, 7, 400,
+	OpExpect, Tok_Comma, 0, 11,
+	OpCall, 405,
+	OpJump, 389,
+	OpExpect, Tok_Semi, 0, 11,
+	OpRet,
+	// 405: label_
+	OpNode, SynTree::R_label_,
+	OpExpect, Tok_digit_sequence, 0, 12,
+	OpRet,
+	// 412: constant_declaration_part
+	OpNode, SynTree::R_constant_declaration_part,
+	OpExpect, Tok_const, 0, 13,
+	OpCall, 428,
+	OpJumpIfNot, 23, 427,
+	OpCall, 428,
+	OpJump, 420,
+	OpRet,
+	// 428: constant_declaration
+	OpNode, SynTree::R_constant_declaration,
+	OpExpect, Tok_identifier, 0, 14,
+	OpExpect, Tok_Eq, 0, 14,
+	OpCall, 1392,
+	OpJumpIfNot, 24, 449,
+	OpExpect, Tok_Semi, 0, 14,
+	OpJump, 449,
+	OpRet,
+	// 450: constant
+	OpNode, SynTree::R_constant,
+	OpJumpIfNot, 25, 489,
+	OpJumpIfNot, 26, 462,
+	OpCall, 2440,
+	OpJump, 462,
+	OpJumpIfNot, 23, 478,
+	OpExpect, Tok_identifier, 0, 15,
+	OpJumpIfNot, 5, 476,
+	OpCall, 1363,
+	OpJump, 476,
+	OpJump, 487,
+	OpJumpIfNot, 27, 485,
+	OpCall, 2419,
+	OpJump, 487,
+	OpInvalid, 15,
+	OpJump, 500,
+	OpJumpIfNot, 28, 498,
+	OpExpect, Tok_string_literal, 0, 15,
+	OpJump, 500,
+	OpInvalid, 15,
+	OpRet,
+	// 501: type_declaration_part
+	OpNode, SynTree::R_type_declaration_part,
+	OpExpect, Tok_type, 0, 16,
+	OpCall, 517,
+	OpJumpIfNot, 23, 516,
+	OpCall, 517,
+	OpJump, 509,
+	OpRet,
+	// 517: type_declaration
+	OpNode, SynTree::R_type_declaration,
+	OpExpect, Tok_identifier, 0, 17,
+	OpExpect, Tok_Eq, 0, 17,
+	OpCall, 1830,
+	OpExpect, Tok_Semi, 0, 17,
+	OpRet,
+	// 534: variable_declaration_part
+	OpNode, SynTree::R_variable_declaration_part,
+	OpExpect, Tok_var, 0, 18,
+	OpCall, 550,
+	OpJumpIfNot, 23, 549,
+	OpCall, 550,
+	OpJump, 542,
+	OpRet,
+	// 550: variable_declaration
+	OpNode, SynTree::R_variable_declaration,
+	OpCall, 2360,
+	OpExpect, Tok_Colon, 0, 19,
+	OpCall, 1830,
+	OpExpect, Tok_Semi, 0, 19,
+	OpRet,
+	// 565: procedure_and_function_interface_part
+	OpNode, SynTree::R_procedure_and_function_interface_part,
+	OpJumpIfNot, 18, 596,
+	OpJumpIfNot, 29, 581,
+	OpCall, 788,
+	OpExpect, Tok_Semi, 0, 20,
+	OpJump, 594,
+	OpJumpIfNot, 30, 592,
+	OpCall, 819,
+	OpExpect, Tok_Semi, 0, 20,
+	OpJump, 594,
+	OpInvalid, 20,
+	OpJump, 567,
+	OpRet,
+	// 597: procedure_and_function_declaration_part
+	OpNode, SynTree::R_procedure_and_function_declaration_part,
+	OpJumpIfNot, 18, 620,
+	OpJumpIfNot, 29, 609,
+	OpCall, 710,
+	OpJump, 618,
+	OpJumpIfNot, 30, 616,
+	OpCall, 768,
+	OpJump, 618,
+	OpInvalid, 21,
+	OpJump, 599,
+	OpRet,
+	// 621: subroutine_part
+	OpNode, SynTree::R_subroutine_part,
+	OpJumpIfNot, 31, 651,
+	OpJumpIfNot, 29, 633,
+	OpCall, 710,
+	OpJump, 649,
+	OpJumpIfNot, 30, 640,
+	OpCall, 768,
+	OpJump, 649,
+	OpJumpIfNot, 32, 647,
+	OpCall, 652,
+	OpJump, 649,
+	OpInvalid, 22,
+	OpJump, 623,
+	OpRet,
+	// 652: method_block
+	OpNode, SynTree::R_method_block,
+	OpExpect, Tok_methods, 0, 23,
+	OpExpect, Tok_of, 0, 23,
+	OpExpect, Tok_identifier, 0, 23,
+	OpJumpIfNot, 24, 675,
+	OpExpect, Tok_Semi, 0, 23,
+	OpJump, 675,
+	OpJumpIfNot, 18, 682,
+	OpCall, 597,
+	OpJump, 682,
+	OpJumpIfNot, 4, 689,
+	OpCall, 783,
+	OpJump, 700,
+	OpJumpIfNot, 10, 698,
+	OpExpect, Tok_end, 0, 23,
+	OpJump, 700,
+	OpInvalid, 23,
+	OpJumpIfNot, 24, 709,
+	OpExpect, Tok_Semi, 0, 23,
+	OpJump, 709,
+	OpRet,
+	// 710: procedure_declaration
+	OpNode, SynTree::R_procedure_declaration,
+	OpCall, 788,
+	OpExpect, Tok_Semi, 0, 24,
+	OpCall, 725,
+	OpExpect, Tok_Semi, 0, 24,
+	OpRet,
+	// 725: body_
+	OpNode, SynTree::R_body_,
+	OpJumpIfNot, 33, 736,
+	OpCall, 336,
+	OpCall, 783,
+	OpJump, 767,
+	OpJumpIfNot, 34, 745,
+	OpExpect, Tok_forward, 1, 25,
+	OpJump, 767,
+	OpJumpIfNot, 35, 754,
+	OpExpect, Tok_external, 1, 25,
+	OpJump, 767,
+	OpJumpIfNot, 36, 765,
+	OpExpect, Tok_inline, 1, 25,
+	OpCall, 450,
+	OpJump, 767,
+	OpInvalid, 25,
+	OpRet,
+	// 768: function_declaration
+	OpNode, SynTree::R_function_declaration,
+	OpCall, 819,
+	OpExpect, Tok_Semi, 0, 26,
+	OpCall, 725,
+	OpExpect, Tok_Semi, 0, 26,
+	OpRet,
+	// 783: statement_part
+	OpNode, SynTree::R_statement_part,
+	OpCall, 1069,
+	OpRet,
+	// 788: procedure_heading
+	OpNode, SynTree::R_procedure_heading,
+	OpExpect, Tok_procedure, 0, 27,
+	OpExpect, Tok_identifier, 0, 27,
+	OpJumpIfNot, 37, 811,
+	OpExpect, Tok_Dot, 0, 27,
+	OpExpect, Tok_identifier, 0, 27,
+	OpJump, 811,
+	OpJumpIfNot, 5, 818,
+	OpCall, 866,
+	OpJump, 818,
+	OpRet,
+	// 819: function_heading
+	OpNode, SynTree::R_function_heading,
+	OpExpect, Tok_function, 0, 28,
+	OpExpect, Tok_identifier, 0, 28,
+	OpJumpIfNot, 37, 842,
+	OpExpect, Tok_Dot, 0, 28,
+	OpExpect, Tok_identifier, 0, 28,
+	OpJump, 842,
+	OpJumpIfNot, 5, 849,
+	OpCall, 866,
+	OpJump, 849,
+	OpJumpIfNot, 38, 860,
+	OpExpect, Tok_Colon, 0, 28,
+	OpCall, 861,
+	OpJump, 860,
+	OpRet,
+	// 861: result_type
+	OpNode, SynTree::R_result_type,
+	OpCall, 2353,
+	OpRet,
+	// 866: formal_parameter_list
+	OpNode, SynTree::R_formal_parameter_list,
+	OpExpect, Tok_Lpar, 0, 29,
+	OpCall, 895,
+	OpJumpIfNot, 39, 890,
+	OpJumpIfNot, 24, 886,
+	OpExpect, Tok_Semi, 0, 29,
+	OpJump, 886,
+	OpCall, 895,
+	OpJump, 874,
+	OpExpect, Tok_Rpar, 0, 29,
+	OpRet,
+	// 895: formal_parameter_section
+	OpNode, SynTree::R_formal_parameter_section,
+	OpJumpIfNot, 40, 904,
+	OpCall, 921,
+	OpJump, 920,
+	OpJumpIfNot, 29, 911,
+	OpCall, 788,
+	OpJump, 920,
+	OpJumpIfNot, 30, 918,
+	OpCall, 819,
+	OpJump, 920,
+	OpInvalid, 30,
+	OpRet,
+	// 921: parameter_declaration
+	OpNode, SynTree::R_parameter_declaration,
+	OpJumpIfNot, 14, 932,
+	OpExpect, Tok_var, 0, 31,
+	OpJump, 932,
+	OpCall, 2360,
+	OpExpect, Tok_Colon, 0, 31,
+	OpCall, 2353,
+	OpRet,
+	// 941: statement_sequence
+	OpNode, SynTree::R_statement_sequence,
+	OpCall, 957,
+	OpJumpIfNot, 24, 956,
+	OpExpect, Tok_Semi, 0, 32,
+	OpCall, 957,
+	OpJump, 945,
+	OpRet,
+	// 957: statement
+	OpNode, SynTree::R_statement,
+	OpJumpIfNot, 41, 970,
+	OpCall, 405,
+	OpExpect, Tok_Colon, 0, 33,
+	OpJump, 970,
+	OpJumpIfNot, 42, 982,
+	OpJumpIfNot, 43, 980,
+	OpCall, 992,
+	OpJump, 980,
+	OpJump, 991,
+	OpJumpIfNot, 44, 989,
+	OpCall, 1036,
+	OpJump, 991,
+	OpInvalid, 33,
+	OpRet,
+	// 992: simple_statement
+	OpNode, SynTree::R_simple_statement,
+	OpJumpIfNot, 23, 1001,
+	OpCall, 1011,
+	OpJump, 1010,
+	OpJumpIfNot, 45, 1008,
+	OpCall, 1027,
+	OpJump, 1010,
+	OpInvalid, 34,
+	OpRet,
+	// 1011: assigOrCall
+	OpNode, SynTree::R_assigOrCall,
+	OpCall, 1704,
+	OpJumpIfNot, 46, 1026,
+	OpExpect, Tok_ColonEq, 0, 35,
+	OpCall, 1392,
+	OpJump, 1026,
+	OpRet,
+	// 1027: goto_statement
+	OpNode, SynTree::R_goto_statement,
+	OpExpect, Tok_goto, 0, 36,
+	OpCall, 405,
+	OpRet,
+	// 1036: structured_statement
+	OpNode, SynTree::R_structured_statement,
+	OpJumpIfNot, 4, 1045,
+	OpCall, 1069,
+	OpJump, 1068,
+	OpJumpIfNot, 47, 1052,
+	OpCall, 1082,
+	OpJump, 1068,
+	OpJumpIfNot, 48, 1059,
+	OpCall, 1191,
+	OpJump, 1068,
+	OpJumpIfNot, 49, 1066,
+	OpCall, 1337,
+	OpJump, 1068,
+	OpInvalid, 37,
+	OpRet,
+	// 1069: compound_statement
+	OpNode, SynTree::R_compound_statement,
+	OpExpect, Tok_begin, 0, 38,
+	OpCall, 941,
+	OpExpect, Tok_end, 0, 38,
+	OpRet,
+	// 1082: repetitive_statement
+	OpNode, SynTree::R_repetitive_statement,
+	OpJumpIfNot, 50, 1091,
+	OpCall, 1108,
+	OpJump, 1107,
+	OpJumpIfNot, 51, 1098,
+	OpCall, 1123,
+	OpJump, 1107,
+	OpJumpIfNot, 52, 1105,
+	OpCall, 1138,
+	OpJump, 1107,
+	OpInvalid, 39,
+	OpRet,
+	// 1108: while_statement
+	OpNode, SynTree::R_while_statement,
+	OpExpect, Tok_while, 0, 40,
+	OpCall, 1392,
+	OpExpect, Tok_do, 0, 40,
+	OpCall, 957,
+	OpRet,
+	// 1123: repeat_statement
+	OpNode, SynTree::R_repeat_statement,
+	OpExpect, Tok_repeat, 0, 41,
+	OpCall, 941,
+	OpExpect, Tok_until, 0, 41,
+	OpCall, 1392,
+	OpRet,
+	// 1138: for_statement
+	OpNode, SynTree::R_for_statement,
+	OpExpect, Tok_for, 0, 42,
+	OpCall, 2346,
+	OpExpect, Tok_ColonEq, 0, 42,
+	OpCall, 1181,
+	OpJumpIfNot, 53, 1161,
+	OpExpect, Tok_to, 0, 42,
+	OpJump, 1172,
+	OpJumpIfNot, 54, 1170,
+	OpExpect, Tok_downto, 0, 42,
+	OpJump, 1172,
+	OpInvalid, 42,
+	OpCall, 1186,
+	OpExpect, Tok_do, 0, 42,
+	OpCall, 957,
+	OpRet,
+	// 1181: initial_value
+	OpNode, SynTree::R_initial_value,
+	OpCall, 1392,
+	OpRet,
+	// 1186: final_value
+	OpNode, SynTree::R_final_value,
+	OpCall, 1392,
+	OpRet,
+	// 1191: conditional_statement
+	OpNode, SynTree::R_conditional_statement,
+	OpJumpIfNot, 55, 1200,
+	OpCall, 1210,
+	OpJump, 1209,
+	OpJumpIfNot, 56, 1207,
+	OpCall, 1236,
+	OpJump, 1209,
+	OpInvalid, 43,
+	OpRet,
+	// 1210: if_statement
+	OpNode, SynTree::R_if_statement,
+	OpExpect, Tok_if, 0, 44,
+	OpCall, 1392,
+	OpExpect, Tok_then, 0, 44,
+	OpCall, 957,
+	OpJumpIfNot, 57, 1235,
+	OpExpect, Tok_else, 0, 44,
+	OpCall, 957,
+	OpJump, 1235,
+	OpRet,
+	// 1236: case_statement
+	OpNode, SynTree::R_case_statement,
+	OpExpect, Tok_case, 0, 45,
+	OpCall, 1392,
+	OpExpect, Tok_of, 0, 45,
+	OpJumpIfNot, 58, 1271,
+	OpCall, 1292,
+	OpJumpIfNot, 59, 1269,
+	OpExpect, Tok_Semi, 0, 45,
+	OpJumpIfNot, 58, 1267,
+	OpCall, 1292,
+	OpJump, 1267,
+	OpJump, 1253,
+	OpJump, 1271,
+	OpJumpIfNot, 60, 1278,
+	OpCall, 1319,
+	OpJump, 1278,
+	OpJumpIfNot, 24, 1287,
+	OpExpect, Tok_Semi, 0, 45,
+	OpJump, 1287,
+	OpExpect, Tok_end, 0, 45,
+	OpRet,
+	// 1292: case_limb
+	OpNode, SynTree::R_case_limb,
+	OpCall, 1303,
+	OpExpect, Tok_Colon, 0, 46,
+	OpCall, 957,
+	OpRet,
+	// 1303: case_label_list
+	OpNode, SynTree::R_case_label_list,
+	OpCall, 450,
+	OpJumpIfNot, 7, 1318,
+	OpExpect, Tok_Comma, 0, 47,
+	OpCall, 450,
+	OpJump, 1307,
+	OpRet,
+	// 1319: otherwise_clause
+	OpNode, SynTree::R_otherwise_clause,
+	OpJumpIfNot, 24, 1330,
+	OpExpect, Tok_Semi, 0, 48,
+	OpJump, 1330,
+	OpExpect, Tok_otherwise, 0, 48,
+	OpCall, 957,
+	OpRet,
+	// 1337: with_statement
+	OpNode, SynTree::R_with_statement,
+	OpExpect, Tok_with, 0, 49,
+	OpCall, 1704,
+	OpJumpIfNot, 7, 1356,
+	OpExpect, Tok_Comma, 0, 49,
+	OpCall, 1704,
+	OpJump, 1345,
+	OpExpect, Tok_do, 0, 49,
+	OpCall, 957,
+	OpRet,
+	// 1363: actual_parameter_list
+	OpNode, SynTree::R_actual_parameter_list,
+	OpExpect, Tok_Lpar, 0, 50,
+	OpCall, 1387,
+	OpJumpIfNot, 7, 1382,
+	OpExpect, Tok_Comma, 0, 50,
+	OpCall, 1387,
+	OpJump, 1371,
+	OpExpect, Tok_Rpar, 0, 50,
+	OpRet,
+	// 1387: actual_parameter
+	OpNode, SynTree::R_actual_parameter,
+	OpCall, 1392,
+	OpRet,
+	// 1392: expression
+	OpNode, SynTree::R_expression,
+	OpCall, 1406,
+	OpJumpIfNot, 61, 1405,
+	OpCall, 1545,
+	OpCall, 1406,
+	OpJump, 1405,
+	OpRet,
+	// 1406: simple_expression
+	OpNode, SynTree::R_simple_expression,
+	OpJumpIfNot, 26, 1415,
+	OpCall, 2440,
+	OpJump, 1415,
+	OpCall, 1427,
+	OpJumpIfNot, 62, 1426,
+	OpCall, 1613,
+	OpCall, 1427,
+	OpJump, 1417,
+	OpRet,
+	// 1427: term
+	OpNode, SynTree::R_term,
+	OpCall, 1441,
+	OpJumpIfNot, 63, 1440,
+	OpCall, 1645,
+	OpCall, 1441,
+	OpJump, 1431,
+	OpRet,
+	// 1441: factor
+	OpNode, SynTree::R_factor,
+	OpJumpIfNot, 64, 1454,
+	OpExpect, Tok_At, 0, 51,
+	OpCall, 1704,
+	OpJump, 1544,
+	OpJumpIfNot, 23, 1484,
+	OpExpect, Tok_identifier, 0, 51,
+	OpJumpIfNot, 65, 1482,
+	OpJumpIfNot, 66, 1471,
+	OpCall, 1730,
+	OpJump, 1480,
+	OpJumpIfNot, 5, 1478,
+	OpCall, 1363,
+	OpJump, 1480,
+	OpInvalid, 51,
+	OpJump, 1461,
+	OpJump, 1544,
+	OpJumpIfNot, 27, 1491,
+	OpCall, 2419,
+	OpJump, 1544,
+	OpJumpIfNot, 28, 1500,
+	OpExpect, Tok_string_literal, 0, 51,
+	OpJump, 1544,
+	OpJumpIfNot, 67, 1509,
+	OpExpect, Tok_nil, 0, 51,
+	OpJump, 1544,
+	OpJumpIfNot, 68, 1516,
+	OpCall, 1785,
+	OpJump, 1544,
+	OpJumpIfNot, 5, 1531,
+	OpExpect, Tok_Lpar, 0, 51,
+	OpCall, 1392,
+	OpExpect, Tok_Rpar, 0, 51,
+	OpJump, 1544,
+	OpJumpIfNot, 69, 1542,
+	OpExpect, Tok_not, 0, 51,
+	OpCall, 1441,
+	OpJump, 1544,
+	OpInvalid, 51,
+	OpRet,
+	// 1545: relational_operator
+	OpNode, SynTree::R_relational_operator,
+	OpJumpIfNot, 70, 1556,
+	OpExpect, Tok_Eq, 0, 52,
+	OpJump, 1612,
+	OpJumpIfNot, 71, 1565,
+	OpExpect, Tok_LtGt, 0, 52,
+	OpJump, 1612,
+	OpJumpIfNot, 72, 1574,
+	OpExpect, Tok_Lt, 0, 52,
+	OpJump, 1612,
+	OpJumpIfNot, 73, 1583,
+	OpExpect, Tok_Leq, 0, 52,
+	OpJump, 1612,
+	OpJumpIfNot, 74, 1592,
+	OpExpect, Tok_Gt, 0, 52,
+	OpJump, 1612,
+	OpJumpIfNot, 75, 1601,
+	OpExpect, Tok_Geq, 0, 52,
+	OpJump, 1612,
+	OpJumpIfNot, 76, 1610,
+	OpExpect, Tok_in, 0, 52,
+	OpJump, 1612,
+	OpInvalid, 52,
+	OpRet,
+	// 1613: addition_operator
+	OpNode, SynTree::R_addition_operator,
+	OpJumpIfNot, 77, 1624,
+	OpExpect, Tok_Plus, 0, 53,
+	OpJump, 1644,
+	OpJumpIfNot, 78, 1633,
+	OpExpect, Tok_Minus, 0, 53,
+	OpJump, 1644,
+	OpJumpIfNot, 79, 1642,
+	OpExpect, Tok_or, 0, 53,
+	OpJump, 1644,
+	OpInvalid, 53,
+	OpRet,
+	// 1645: multiplication_operator
+	OpNode, SynTree::R_multiplication_operator,
+	OpJumpIfNot, 80, 1656,
+	OpExpect, Tok_Star, 0, 54,
+	OpJump, 1703,
+	OpJumpIfNot, 6, 1665,
+	OpExpect, Tok_Slash, 0, 54,
+	OpJump, 1703,
+	OpJumpIfNot, 38, 1674,
+	OpExpect, Tok_Colon, 0, 54,
+	OpJump, 1703,
+	OpJumpIfNot, 81, 1683,
+	OpExpect, Tok_div, 0, 54,
+	OpJump, 1703,
+	OpJumpIfNot, 82, 1692,
+	OpExpect, Tok_mod, 0, 54,
+	OpJump, 1703,
+	OpJumpIfNot, 83, 1701,
+	OpExpect, Tok_and, 0, 54,
+	OpJump, 1703,
+	OpInvalid, 54,
+	OpRet,
+	// 1704: variable_reference
+	OpNode, SynTree::R_variable_reference,
+	OpCall, 2346,
+	OpJumpIfNot, 65, 1729,
+	OpJumpIfNot, 66, 1718,
+	OpCall, 1730,
+	OpJump, 1727,
+	OpJumpIfNot, 5, 1725,
+	OpCall, 1363,
+	OpJump, 1727,
+	OpInvalid, 55,
+	OpJump, 1708,
+	OpRet,
+	// 1730: qualifier
+	OpNode, SynTree::R_qualifier,
+	OpJumpIfNot, 68, 1739,
+	OpCall, 1756,
+	OpJump, 1755,
+	OpJumpIfNot, 37, 1746,
+	OpCall, 1769,
+	OpJump, 1755,
+	OpJumpIfNot, 84, 1753,
+	OpCall, 1778,
+	OpJump, 1755,
+	OpInvalid, 56,
+	OpRet,
+	// 1756: index
+	OpNode, SynTree::R_index,
+	OpExpect, Tok_Lbrack, 0, 57,
+	OpCall, 2380,
+	OpExpect, Tok_Rbrack, 0, 57,
+	OpRet,
+	// 1769: field_designator
+	OpNode, SynTree::R_field_designator,
+	OpExpect, Tok_Dot, 0, 58,
+	OpCall, 2339,
+	OpRet,
+	// 1778: dereferencer
+	OpNode, SynTree::R_dereferencer,
+	OpExpect, Tok_Hat, 0, 59,
+	OpRet,
+	// 1785: set_literal
+	OpNode, SynTree::R_set_literal,
+	OpExpect, Tok_Lbrack, 0, 60,
+	OpJumpIfNot, 85, 1809,
+	OpCall, 1814,
+	OpJumpIfNot, 7, 1807,
+	OpExpect, Tok_Comma, 0, 60,
+	OpCall, 1814,
+	OpJump, 1796,
+	OpJump, 1809,
+	OpExpect, Tok_Rbrack, 0, 60,
+	OpRet,
+	// 1814: member_group
+	OpNode, SynTree::R_member_group,
+	OpCall, 1392,
+	OpJumpIfNot, 86, 1829,
+	OpExpect, Tok_2Dot, 0, 61,
+	OpCall, 1392,
+	OpJump, 1829,
+	OpRet,
+	// 1830: type_
+	OpNode, SynTree::R_type_,
+	OpJumpIfNot, 87, 1839,
+	OpCall, 1863,
+	OpJump, 1862,
+	OpJumpIfNot, 88, 1846,
+	OpCall, 1896,
+	OpJump, 1862,
+	OpJumpIfNot, 89, 1853,
+	OpCall, 1974,
+	OpJump, 1862,
+	OpJumpIfNot, 84, 1860,
+	OpCall, 2093,
+	OpJump, 1862,
+	OpInvalid, 62,
+	OpRet,
+	// 1863: simple_type
+	OpNode, SynTree::R_simple_type,
+	OpJumpIfNot, 90, 1874,
+	OpExpect, Tok_identifier, 0, 63,
+	OpJump, 1890,
+	OpJumpIfNot, 58, 1881,
+	OpCall, 1947,
+	OpJump, 1890,
+	OpJumpIfNot, 5, 1888,
+	OpCall, 1934,
+	OpJump, 1890,
+	OpInvalid, 63,
+	OpRet,
+	// 1891: ordinal_type
+	OpNode, SynTree::R_ordinal_type,
+	OpCall, 1863,
+	OpRet,
+	// 1896: string_type
+	OpNode, SynTree::R_string_type,
+	OpExpect, Tok_string, 0, 64,
+	OpExpect, Tok_Lbrack, 0, 64,
+	OpCall, 1913,
+	OpExpect, Tok_Rbrack, 0, 64,
+	OpRet,
+	// 1913: size_attribute
+	OpNode, SynTree::R_size_attribute,
+	OpJumpIfNot, 91, 1922,
+	OpCall, 2396,
+	OpJump, 1933,
+	OpJumpIfNot, 23, 1931,
+	OpExpect, Tok_identifier, 0, 65,
+	OpJump, 1933,
+	OpInvalid, 65,
+	OpRet,
+	// 1934: enumerated_type
+	OpNode, SynTree::R_enumerated_type,
+	OpExpect, Tok_Lpar, 0, 66,
+	OpCall, 2360,
+	OpExpect, Tok_Rpar, 0, 66,
+	OpRet,
+	// 1947: subrange_type
+	OpNode, SynTree::R_subrange_type,
+	OpCall, 450,
+	OpJumpIfNot, 86, 1960,
+	OpExpect, Tok_2Dot, 0, 67,
+	OpJump, 1971,
+	OpJumpIfNot, 38, 1969,
+	OpExpect, Tok_Colon, 0, 67,
+	OpJump, 1971,
+	OpInvalid, 67,
+	OpCall, 450,
+	OpRet,
+	// 1974: structured_type
+	OpNode, SynTree::R_structured_type,
+	OpJumpIfNot, 92, 1985,
+	OpExpect, Tok_packed, 0, 68,
+	OpJump, 1985,
+	OpJumpIfNot, 93, 1992,
+	OpCall, 2023,
+	OpJump, 2022,
+	OpJumpIfNot, 94, 1999,
+	OpCall, 2187,
+	OpJump, 2022,
+	OpJumpIfNot, 95, 2006,
+	OpCall, 2062,
+	OpJump, 2022,
+	OpJumpIfNot, 96, 2013,
+	OpCall, 2075,
+	OpJump, 2022,
+	OpJumpIfNot, 97, 2020,
+	OpCall, 2102,
+	OpJump, 2022,
+	OpInvalid, 68,
+	OpRet,
+	// 2023: array_type
+	OpNode, SynTree::R_array_type,
+	OpExpect, Tok_array, 0, 69,
+	OpExpect, Tok_Lbrack, 0, 69,
+	OpCall, 2057,
+	OpJumpIfNot, 7, 2046,
+	OpExpect, Tok_Comma, 0, 69,
+	OpCall, 2057,
+	OpJump, 2035,
+	OpExpect, Tok_Rbrack, 0, 69,
+	OpExpect, Tok_of, 0, 69,
+	OpCall, 1830,
+	OpRet,
+	// 2057: index_type
+	OpNode, SynTree::R_index_type,
+	OpCall, 1891,
+	OpRet,
+	// 2062: set_type
+	OpNode, SynTree::R_set_type,
+	OpExpect, Tok_set, 0, 70,
+	OpExpect, Tok_of, 0, 70,
+	OpCall, 1891,
+	OpRet,
+	// 2075: file_type
+	OpNode, SynTree::R_file_type,
+	OpExpect, Tok_file, 0, 71,
+	OpJumpIfNot, 98, 2092,
+	OpExpect, Tok_of, 0, 71,
+	OpCall, 1830,
+	OpJump, 2092,
+	OpRet,
+	// 2093: pointer_type
+	OpNode, SynTree::R_pointer_type,
+	OpExpect, Tok_Hat, 0, 72,
+	OpCall, 2353,
+	OpRet,
+	// 2102: class_type
+	OpNode, SynTree::R_class_type,
+	OpExpect, Tok_subclass, 0, 73,
+	OpExpect, Tok_of, 0, 73,
+	OpJumpIfNot, 23, 2119,
+	OpCall, 2353,
+	OpJump, 2130,
+	OpJumpIfNot, 67, 2128,
+	OpExpect, Tok_nil, 0, 73,
+	OpJump, 2130,
+	OpInvalid, 73,
+	OpJumpIfNot, 99, 2137,
+	OpCall, 2205,
+	OpJump, 2137,
+	OpCall, 2151,
+	OpJumpIfNot, 18, 2146,
+	OpCall, 2151,
+	OpJump, 2139,
+	OpExpect, Tok_end, 0, 73,
+	OpRet,
+	// 2151: method_interface
+	OpNode, SynTree::R_method_interface,
+	OpJumpIfNot, 29, 2160,
+	OpCall, 788,
+	OpJump, 2169,
+	OpJumpIfNot, 30, 2167,
+	OpCall, 819,
+	OpJump, 2169,
+	OpInvalid, 74,
+	OpJumpIfNot, 100, 2182,
+	OpExpect, Tok_Semi, 0, 74,
+	OpExpect, Tok_identifier, 0, 74,
+	OpJump, 2182,
+	OpExpect, Tok_Semi, 0, 74,
+	OpRet,
+	// 2187: record_type
+	OpNode, SynTree::R_record_type,
+	OpExpect, Tok_record, 0, 75,
+	OpJumpIfNot, 99, 2200,
+	OpCall, 2205,
+	OpJump, 2200,
+	OpExpect, Tok_end, 0, 75,
+	OpRet,
+	// 2205: field_list
+	OpNode, SynTree::R_field_list,
+	OpJumpIfNot, 23, 2225,
+	OpCall, 2244,
+	OpJumpIfNot, 101, 2223,
+	OpExpect, Tok_Semi, 0, 76,
+	OpCall, 2271,
+	OpJump, 2223,
+	OpJump, 2234,
+	OpJumpIfNot, 56, 2232,
+	OpCall, 2271,
+	OpJump, 2234,
+	OpInvalid, 76,
+	OpJumpIfNot, 24, 2243,
+	OpExpect, Tok_Semi, 0, 76,
+	OpJump, 2243,
+	OpRet,
+	// 2244: fixed_part
+	OpNode, SynTree::R_fixed_part,
+	OpCall, 2260,
+	OpJumpIfNot, 100, 2259,
+	OpExpect, Tok_Semi, 0, 77,
+	OpCall, 2260,
+	OpJump, 2248,
+	OpRet,
+	// 2260: field_declaration
+	OpNode, SynTree::R_field_declaration,
+	OpCall, 2360,
+	OpExpect, Tok_Colon, 0, 78,
+	OpCall, 1830,
+	OpRet,
+	// 2271: variant_part
+	OpNode, SynTree::R_variant_part,
+	OpExpect, Tok_case, 0, 79,
+	OpJumpIfNot, 102, 2284,
+	OpCall, 2304,
+	OpJump, 2284,
+	OpCall, 2353,
+	OpExpect, Tok_of, 0, 79,
+	OpCall, 2315,
+	OpJumpIfNot, 103, 2303,
+	OpExpect, Tok_Semi, 0, 79,
+	OpCall, 2315,
+	OpJump, 2292,
+	OpRet,
+	// 2304: tag_field
+	OpNode, SynTree::R_tag_field,
+	OpExpect, Tok_identifier, 0, 80,
+	OpExpect, Tok_Colon, 0, 80,
+	OpRet,
+	// 2315: variant
+	OpNode, SynTree::R_variant,
+	OpCall, 1303,
+	OpExpect, Tok_Colon, 0, 81,
+	OpExpect, Tok_Lpar, 0, 81,
+	OpJumpIfNot, 99, 2334,
+	OpCall, 2205,
+	OpJump, 2334,
+	OpExpect, Tok_Rpar, 0, 81,
+	OpRet,
+	// 2339: field_identifier
+	OpNode, SynTree::R_field_identifier,
+	OpExpect, Tok_identifier, 0, 82,
+	OpRet,
+	// 2346: variable_identifier
+	OpNode, SynTree::R_variable_identifier,
+	OpExpect, Tok_identifier, 0, 83,
+	OpRet,
+	// 2353: type_identifier
+	OpNode, SynTree::R_type_identifier,
+	OpExpect, Tok_identifier, 0, 84,
+	OpRet,
+	// 2360: identifier_list
+	OpNode, SynTree::R_identifier_list,
+	OpExpect, Tok_identifier, 0, 85,
+	OpJumpIfNot, 7, 2379,
+	OpExpect, Tok_Comma, 0, 85,
+	OpExpect, Tok_identifier, 0, 85,
+	OpJump, 2366,
+	OpRet,
+	// 2380: expression_list
+	OpNode, SynTree::R_expression_list,
+	OpCall, 1392,
+	OpJumpIfNot, 7, 2395,
+	OpExpect, Tok_Comma, 0, 86,
+	OpCall, 1392,
+	OpJump, 2384,
+	OpRet,
+	// 2396: unsigned_integer
+	OpNode, SynTree::R_unsigned_integer,
+	OpJumpIfNot, 41, 2407,
+	OpExpect, Tok_digit_sequence, 0, 87,
+	OpJump, 2418,
+	OpJumpIfNot, 104, 2416,
+	OpExpect, Tok_hex_digit_sequence, 0, 87,
+	OpJump, 2418,
+	OpInvalid, 87,
+	OpRet,
+	// 2419: unsigned_number
+	OpNode, SynTree::R_unsigned_number,
+	OpJumpIfNot, 91, 2428,
+	OpCall, 2396,
+	OpJump, 2439,
+	OpJumpIfNot, 105, 2437,
+	OpExpect, Tok_unsigned_real, 0, 88,
+	OpJump, 2439,
+	OpInvalid, 88,
+	OpRet,
+	// 2440: sign
+	OpNode, SynTree::R_sign,
+	OpJumpIfNot, 77, 2451,
+	OpExpect, Tok_Plus, 0, 89,
+	OpJump, 2462,
+	OpJumpIfNot, 78, 2460,
+	OpExpect, Tok_Minus, 0, 89,
+	OpJump, 2462,
+	OpInvalid, 89,
+	OpRet,
+};
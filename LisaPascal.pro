@@ -1,5 +1,4 @@
-QT       += core
-QT       -= gui
+QT       += core gui
 
 TARGET = LisaPascal
 CONFIG   += console
@@ -13,23 +12,48 @@ DEFINES += _DEBUG
 SOURCES += main.cpp \
     LisaLexer.cpp \
     LisaParser.cpp \
+    LisaTableParser.cpp \
     LisaSynTree.cpp \
     LisaTokenType.cpp \
     Converter.cpp \
     LisaFileSystem.cpp \
+    LisaPrefetcher.cpp \
+    LisaSourceStore.cpp \
+    LisaArchive.cpp \
+    LisaFileIndex.cpp \
     LisaPpLexer.cpp \
     LisaToken.cpp \
     AsmLexer.cpp \
-    AsmTokenType.cpp
+    AsmTokenType.cpp \
+    AsmParser.cpp \
+    AsmChunkParser.cpp \
+    AsmPpLexer.cpp \
+    AsmSynTree.cpp \
+    LisaCodeModel.cpp
 
 HEADERS += \
     LisaLexer.h \
     LisaParser.h \
+    LisaTableParser.h \
+    LisaParserTables.h \
     LisaSynTree.h \
     LisaToken.h \
     LisaTokenType.h \
     Converter.h \
     LisaFileSystem.h \
+    LisaPrefetcher.h \
+    LisaSourceStore.h \
+    LisaArchive.h \
+    LisaFileIndex.h \
     LisaPpLexer.h \
+    LisaTokenStream.h \
+    LisaTokenWriter.h \
+    LisaTreeStream.h \
+    LisaTreeWriter.h \
     AsmLexer.h \
-    AsmTokenType.h
+    AsmTokenType.h \
+    AsmParser.h \
+    AsmChunkParser.h \
+    AsmPpLexer.h \
+    AsmSynTree.h \
+    LisaCodeModel.h
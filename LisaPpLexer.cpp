@@ -17,46 +17,135 @@
 #include "LisaPpLexer.h"
 #include <QBuffer>
 #include <QFile>
+#include <QFileInfo>
+#include <QScopedPointer>
+#include <QVarLengthArray>
 #include <QtDebug>
 using namespace Lisa;
 
-PpLexer::PpLexer(FileSystem* fs):d_fs(fs),d_sloc(0)
+PpLexer::PpLexer(FileSystem* fs):d_fs(fs),d_sloc(0),d_interval(0),d_lexSeen(0),d_tokens(0)
 {
     Q_ASSERT(fs);
 }
 
 PpLexer::~PpLexer()
 {
-    for( int i = 0; i < d_files.size(); i++ )
-        delete d_files[i];
+    closeAll();
 }
 
 bool PpLexer::reset(const QString& filePath)
 {
-    d_stack.clear();
+    closeAll();
     d_buffer.clear();
-    for( int i = 0; i < d_files.size(); i++ )
-        delete d_files[i];
-    d_files.clear();
     d_sloc = 0;
     d_includes.clear();
+    d_ppVars = d_preset;
+    d_inputs.clear();
+    d_assigned.clear();
+    d_checkpoints.clear();
+    d_lexSeen = 0;
+    d_tokens = 0;
+    d_path = filePath;
 
     const FileSystem::File* f = d_fs->findFile(filePath);
     if( f == 0 )
         return false;
+    return openTop();
+}
+
+bool PpLexer::openTop()
+{
     d_stack.push_back(Level());
     d_stack.back().d_lex.setIgnoreComments(false);
-    QFile* file = new QFile(filePath);
-    if( !file->open(QIODevice::ReadOnly) )
+    d_stack.back().d_lex.setCheckpointInterval(d_interval);
+    QIODevice* file = d_fs->getStore()->open(d_path);
+    if( file == 0 )
     {
-        delete file;
         d_stack.pop_back();
         return false;
     }
-    d_stack.back().d_lex.setStream(file,filePath);
+    d_stack.back().d_lex.setStream(file,d_path);
+    return true;
+}
+
+void PpLexer::closeAll()
+{
+    if( !d_stack.isEmpty() )
+        delete d_stack.first().d_lex.getDevice();
+    d_stack.clear();
+}
+
+int PpLexer::findCheckpoint(quint32 lineNr) const
+{
+    int i = d_checkpoints.size() - 1;
+    while( i >= 0 && d_checkpoints[i].d_lex.d_lineNr > lineNr )
+        i--;
+    return i;
+}
+
+bool PpLexer::resume(int i)
+{
+    if( i < 0 || i >= d_checkpoints.size() )
+        return false;
+    const Checkpoint cp = d_checkpoints[i];
+    closeAll();
+    if( !openTop() )
+        return false;
+    Level& top = d_stack.back();
+    if( !top.d_lex.resume(cp.d_lex) )
+        return false;
+    while( d_checkpoints.size() > i + 1 )
+        d_checkpoints.pop_back();
+    d_lexSeen = cp.d_lex.d_lineNr;
+    d_tokens = cp.d_tokens;
+    d_buffer.clear();
+    d_sloc = cp.d_sloc;
+    d_ppVars = cp.d_vars;
+    d_conditionStack = cp.d_cond;
+    d_inputs = cp.d_inputs;
+    d_assigned = cp.d_assigned;
+    while( d_includes.size() > cp.d_includes )
+        d_includes.pop_back();
+    top.d_mutes = cp.d_mutes;
+    d_startMute = cp.d_startMute;
+    if( cp.d_skip )
+        top.skipToComment(); // not just if muted; after an invalid directive the tokens are delivered
     return true;
 }
 
+void PpLexer::syncCheckpoints(bool skipped)
+{
+    // called whenever the top level lexer proceeded; pp state then is the state at the start of the
+    // line the lexer recorded its most recent checkpoints for
+    if( d_stack.size() != 1 )
+        return;
+    const QList<Lexer::Checkpoint>& cps = d_stack.first().d_lex.getCheckpoints();
+    if( cps.isEmpty() || cps.last().d_lineNr <= d_lexSeen )
+        return;
+    int i = cps.size() - 1;
+    while( i > 0 && cps[i-1].d_lineNr > d_lexSeen )
+        i--;
+    for( ; i < cps.size(); i++ )
+    {
+        if( cps[i].d_comment != 0 )
+            continue; // a directive might span the line
+        Checkpoint cp;
+        cp.d_lex = cps[i];
+        cp.d_tokens = d_tokens;
+        cp.d_sloc = d_sloc;
+        cp.d_vars = d_ppVars;
+        cp.d_cond = d_conditionStack;
+        cp.d_inputs = d_inputs;
+        cp.d_assigned = d_assigned;
+        cp.d_includes = d_includes.size();
+        cp.d_mutes = d_stack.first().d_mutes;
+        cp.d_startMute = d_startMute;
+        cp.d_skip = skipped;
+        d_checkpoints.append(cp);
+    }
+    d_lexSeen = cps.last().d_lineNr;
+}
+
 Token PpLexer::nextToken()
 {
     Token t;
@@ -65,7 +154,10 @@ Token PpLexer::nextToken()
         t = d_buffer.first();
         d_buffer.pop_front();
     }else
+    {
         t = nextTokenImp();
+        d_tokens++;
+    }
     Q_ASSERT( t.d_type != Tok_Comment );
     return t;
 }
@@ -76,6 +168,7 @@ Token PpLexer::peekToken(quint8 lookAhead)
     while( d_buffer.size() < lookAhead )
     {
         Token t = nextTokenImp();
+        d_tokens++;
         Q_ASSERT( t.d_type != Tok_Comment );
         d_buffer.push_back( t );
     }
@@ -86,15 +179,15 @@ Token PpLexer::nextTokenImp()
 {
     if( d_stack.isEmpty() )
         return Token(Tok_Eof);
-    Token t = d_stack.back().d_lex.nextToken();
+    Token t = d_stack.back().nextToken();
+    syncCheckpoints(false);
     while( t.d_type == Tok_Comment || t.d_type == Tok_Eof )
     {
         const bool statusBefore = ppthis().open;
         if( t.d_type == Tok_Eof )
         {
-            d_files.removeAll(d_stack.back().d_lex.getDevice());
-            delete d_stack.back().d_lex.getDevice();
-            d_sloc += d_stack.back().d_lex.getSloc();
+            delete d_stack.back().d_lex.getDevice(); // null for includes
+            d_sloc += d_stack.back().getSloc();
             d_mutes.insert(t.d_sourcePath, d_stack.back().d_mutes);
             d_stack.pop_back();
             if( d_stack.isEmpty() )
@@ -132,16 +225,11 @@ Token PpLexer::nextTokenImp()
             }else
                 d_stack.back().d_mutes.append(qMakePair(d_startMute,t.toLoc()));
         }
-        if( !ppthis().open )
-        {
-            t = d_stack.back().d_lex.peekToken();
-            while( t.d_type != Tok_Comment && t.d_type != Tok_Eof )
-            {
-                t = d_stack.back().d_lex.nextToken();
-                t = d_stack.back().d_lex.peekToken();
-            }
-        }
-        t = d_stack.back().d_lex.nextToken();
+        const bool skip = !ppthis().open;
+        if( skip )
+            d_stack.back().skipToComment();
+        t = d_stack.back().nextToken();
+        syncCheckpoints(skip);
     }
     return t;
 }
@@ -236,17 +324,22 @@ bool PpLexer::handleInclude(const QByteArray& data, const Token& t)
     Q_ASSERT( f );
     QStringList pathFile = path.split('/');
     const FileSystem::File* found = 0;
+    Include inc;
     if( pathFile.size() == 1 )
     {
         QString name = pathFile[0];
         const int colon = name.indexOf(':');
         if( colon != -1 )
             name = name.mid(colon+1);
+        inc.d_name = name;
         found = d_fs->findFile(f->d_dir, QString(), name);
     }else if( pathFile.size() == 2 )
+    {
+        inc.d_dir = pathFile[0];
+        inc.d_name = pathFile[1];
         found = d_fs->findFile(f->d_dir, pathFile[0], pathFile[1]);
+    }
 
-    Include inc;
     inc.d_inc = found;
     inc.d_loc = t.toLoc();
     inc.d_sourcePath = t.d_sourcePath;
@@ -254,34 +347,31 @@ bool PpLexer::handleInclude(const QByteArray& data, const Token& t)
     d_includes.append(inc);
     if( found )
     {
-        d_stack.push_back(Level());
-        d_stack.back().d_lex.setIgnoreComments(false);
-        QFile* file = new QFile(found->d_realPath);
-        if( !file->open(QIODevice::ReadOnly) )
+        IncludeCache::Ref toks = IncludeCache::instance()->fetch(d_fs,found);
+        if( toks.isNull() )
         {
-            delete file;
-            d_stack.pop_back();
             d_err = QString("file '%1' cannot be opened").arg(data.constData()).toUtf8();
             return false;
         }
-        d_stack.back().d_lex.setStream(file,found->d_realPath);
+        d_stack.push_back(Level());
+        d_stack.back().d_cached = toks;
     }else
         d_err = QString("include file '%1' not found").arg(data.constData()).toUtf8();
     return found;
 }
 
-class PpEval
+class PpCompiler
 {
 public:
-    PpEval(const PpLexer::PpVars& vars, Lexer& lex):d_vars(vars),d_lex(lex){}
-    bool eval()
+    PpCompiler(Lexer& lex, PpCode* code):d_lex(lex),d_code(code),d_depth(0){}
+    bool compile()
     {
         try
         {
-            d_res = ppexpr();
+            ppexpr();
             if( d_lex.nextToken().d_type != Tok_Eof )
             {
-                d_err = "unexpected tokens after expression";
+                d_code->d_err = "unexpected tokens after expression";
                 return false;
             }else
                 return true;
@@ -290,15 +380,61 @@ public:
             return false;
         }
     }
-
-    const QByteArray& getErr() const { return d_err; }
-    int getRes() const { return d_res; }
 protected:
     void error(const QString& msg)
     {
-        d_err = msg.toUtf8();
+        d_code->d_err = msg.toUtf8();
         throw 1;
     }
+    bool isConst(int back) const
+    {
+        // is the instruction back positions before the end a constant
+        return d_starts.size() >= back && d_code->d_ops[d_starts[d_starts.size()-back]] == PpCode::Const;
+    }
+    void gen(PpCode::Op op, qint32 arg = 0)
+    {
+        QVector<qint32>& ops = d_code->d_ops;
+        switch( op )
+        {
+        case PpCode::Const:
+        case PpCode::Var:
+            d_starts << ops.size();
+            ops << op << arg;
+            if( ++d_depth > d_code->d_depth )
+                d_code->d_depth = d_depth;
+            return;
+        case PpCode::Neg:
+        case PpCode::Not:
+            if( isConst(1) )
+            {
+                // fold unary operations on constants
+                qint32& val = ops.last();
+                val = op == PpCode::Neg ? -val : !val;
+                return;
+            }
+            d_starts << ops.size();
+            ops << op;
+            return;
+        default:
+            if( isConst(1) && isConst(2) )
+            {
+                // fold binary operations on constants; division by zero is left to run time
+                qint32 res;
+                if( PpCode::apply(op, ops[ops.size()-3], ops.last(), res) )
+                {
+                    ops.resize(ops.size()-2);
+                    ops.last() = res;
+                    d_starts.pop_back();
+                    d_depth--;
+                    return;
+                }
+            }
+            d_starts << ops.size();
+            ops << op;
+            d_depth--;
+            return;
+        }
+    }
 
     static bool isRel(int op)
     {
@@ -315,38 +451,36 @@ protected:
             return false;
         }
     }
-    int ppexpr()
+    void ppexpr()
     {
-        int res = ppsimpexpr();
+        ppsimpexpr();
         Token t = d_lex.peekToken();
         if( isRel(t.d_type) )
         {
             t = d_lex.nextToken();
-            int rhs = ppsimpexpr();
+            ppsimpexpr();
             switch(t.d_type)
             {
             case Tok_Eq:
-                res = (res == rhs);
+                gen(PpCode::Eq);
                 break;
             case Tok_LtGt:
-                res = (res != rhs);
+                gen(PpCode::Neq);
                 break;
             case Tok_Lt:
-                res = (res < rhs);
+                gen(PpCode::Lt);
                 break;
             case Tok_Leq:
-                res = (res <= rhs);
+                gen(PpCode::Leq);
                 break;
             case Tok_Gt:
-                res = (res > rhs);
+                gen(PpCode::Gt);
                 break;
             case Tok_Geq:
-                res = (res >= rhs);
+                gen(PpCode::Geq);
                 break;
             }
-            t = d_lex.peekToken();
         }
-        return res;
     }
     static bool isAdd(int op)
     {
@@ -360,7 +494,7 @@ protected:
             return false;
         }
     }
-    int ppsimpexpr()
+    void ppsimpexpr()
     {
         Token t = d_lex.peekToken();
         bool minus = false;
@@ -369,32 +503,31 @@ protected:
             d_lex.nextToken();
             minus = t.d_type == Tok_Minus;
         }
-        int res = ppterm();
+        ppterm();
         if( minus )
-            res = -res;
+            gen(PpCode::Neg);
 
         t = d_lex.peekToken();
         while( isAdd(t.d_type) )
         {
             t = d_lex.nextToken();
-            int rhs = ppterm();
+            ppterm();
             switch(t.d_type)
             {
             case Tok_Plus:
-                res = (res + rhs);
+                gen(PpCode::Add);
                 break;
             case Tok_Minus:
-                res = (res - rhs);
+                gen(PpCode::Sub);
                 break;
             case Tok_or:
-                res = (res || rhs);
+                gen(PpCode::Or);
                 break;
             default:
                 error(QString("unexpected operator '%1' in term").arg(tokenTypeString(t.d_type)));
             }
             t = d_lex.peekToken();
         }
-        return res;
     }
     static bool isMult(int op)
     {
@@ -411,124 +544,327 @@ protected:
             return false;
         }
     }
-    int ppterm()
+    void ppterm()
     {
-        int res = ppfactor();
+        ppfactor();
         Token t = d_lex.peekToken();
         while( isMult(t.d_type) )
         {
             t = d_lex.nextToken();
-            int rhs = ppfactor();
+            ppfactor();
             switch(t.d_type)
             {
             case Tok_Star:
-                res = (res * rhs);
+                gen(PpCode::Mul);
                 break;
             case Tok_Slash:
             case Tok_div:
             case Tok_Colon:
-                res = (res / rhs);
+                gen(PpCode::Div);
                 break;
             case Tok_mod:
-                res = (res % rhs);
+                gen(PpCode::Mod);
                 break;
             case Tok_and:
-                res = (res && rhs);
+                gen(PpCode::And);
                 break;
             default:
                 error(QString("unexpected operator '%1' in term").arg(tokenTypeString(t.d_type)));
             }
             t = d_lex.peekToken();
         }
-        return res;
     }
-    int ppfactor()
+    void ppfactor()
     {
         Token t = d_lex.nextToken();
         switch( t.d_type )
         {
         case Tok_digit_sequence:
-            return t.d_val.toInt();
+            gen(PpCode::Const, t.d_val.toInt());
+            break;
         case Tok_hex_digit_sequence:
-            return QByteArray::fromHex(t.d_val.mid(1)).toInt();
+            gen(PpCode::Const, QByteArray::fromHex(t.d_val.mid(1)).toInt());
+            break;
         case Tok_identifier:
             {
                 const QByteArray name = t.d_val.toLower();
                 if( name == "true" )
-                    return 1;
-                if( name == "false" )
-                    return 0;
-#if 0
-                // apparently we don't care:
-                if( !d_vars.contains(name) )
-                    error(QString("preprocessor variable '%1' not defined").arg(t.d_val.constData()));
+                    gen(PpCode::Const, 1);
+                else if( name == "false" )
+                    gen(PpCode::Const, 0);
                 else
-#endif
-                    return d_vars.value(name);
+                {
+                    // undefined variables evaluate to 0
+                    const int slot = PpCode::slot(name);
+                    if( !d_code->d_reads.contains(slot) )
+                        d_code->d_reads.append(slot);
+                    gen(PpCode::Var, slot);
+                }
             }
             break;
         case Tok_Lpar:
             {
-                const int res = ppexpr();
+                ppexpr();
                 t = d_lex.nextToken();
                 if( t.d_type != Tok_Rpar )
                     error("expecting ')' after '(' in factor");
-                return res;
             }
             break;
         case Tok_not:
-            {
-                const int res = ppfactor();
-                return !res;
-            }
+            ppfactor();
+            gen(PpCode::Not);
             break;
         default:
             error(QString("factor '%1' not supported").arg(tokenTypeString(t.d_type)));
         }
-        return int();
     }
 private:
-    PpLexer::PpVars d_vars;
     Lexer& d_lex;
-    QByteArray d_err;
-    int d_res;
+    PpCode* d_code;
+    int d_depth;
+    QVector<int> d_starts; // start index of each instruction in d_code->d_ops
 };
 
-bool PpLexer::handleSetc(const QByteArray& data)
+struct PpCodeTables
+{
+    QMutex d_lock;
+    QHash<QByteArray,int> d_slots; // lower case variable name -> slot
+    QHash<QByteArray,PpCode::Ref> d_cache; // kind + directive text -> code
+    quint32 d_hits, d_misses;
+    PpCodeTables():d_hits(0),d_misses(0){}
+};
+
+static PpCodeTables* tables()
+{
+    static PpCodeTables s_tables;
+    return &s_tables;
+}
+
+PpCode::Ref PpCode::compile(const QByteArray& directive, bool setc)
 {
-    QByteArray statement = data;
+    PpCodeTables* t = tables();
+    const QByteArray key = ( setc ? "S" : "I" ) + directive;
+    {
+        QMutexLocker lock(&t->d_lock);
+        Ref res = t->d_cache.value(key);
+        if( !res.isNull() )
+        {
+            t->d_hits++;
+            return res;
+        }
+    }
+
+    PpCode* code = new PpCode();
+    Ref res(code);
+    QByteArray statement = directive;
     QBuffer buf(&statement);
     buf.open(QIODevice::ReadOnly);
     Lexer lex;
     lex.setStream(&buf);
-    Token tt = lex.nextToken();
-    if( tt.d_type != Tok_identifier )
-        return error("expecting identifier on left side of SETC assignment");
-    const QByteArray var = tt.d_val.toLower();
-    if( var == "true" || var == "false" )
-        return error("cannot assign to true or false in SETC");
-    tt = lex.nextToken();
-    if( tt.d_type != Tok_ColonEq && tt.d_type != Tok_Eq )
-        return error("expecting ':=' or '=' in SETC assignment");
-    PpEval e(d_ppVars,lex);
-    if( !e.eval() )
-        return error(QString("%1 in SETC expression").arg(e.getErr().constData()));
-    d_ppVars[var] = e.getRes();
+    if( setc )
+    {
+        Token tt = lex.nextToken();
+        if( tt.d_type != Tok_identifier )
+            code->d_err = "expecting identifier on left side of SETC assignment";
+        else
+        {
+            const QByteArray var = tt.d_val.toLower();
+            tt = lex.nextToken();
+            if( var == "true" || var == "false" )
+                code->d_err = "cannot assign to true or false in SETC";
+            else if( tt.d_type != Tok_ColonEq && tt.d_type != Tok_Eq )
+                code->d_err = "expecting ':=' or '=' in SETC assignment";
+            else
+                code->d_target = slot(var);
+        }
+    }
+    if( code->d_err.isEmpty() )
+    {
+        PpCompiler c(lex,code);
+        if( !c.compile() )
+        {
+            code->d_err = QString("%1 in SETC expression").arg(code->d_err.constData()).toUtf8();
+            code->d_ops.clear();
+        }
+    }
+
+    QMutexLocker lock(&t->d_lock);
+    t->d_misses++;
+    // another thread might have compiled the same text meanwhile; both results are equivalent
+    t->d_cache.insert(key,res);
+    return res;
+}
+
+int PpCode::slot(const QByteArray& name)
+{
+    PpCodeTables* t = tables();
+    QMutexLocker lock(&t->d_lock);
+    QHash<QByteArray,int>::const_iterator i = t->d_slots.find(name);
+    if( i != t->d_slots.end() )
+        return i.value();
+    const int res = t->d_slots.size();
+    t->d_slots.insert(name,res);
+    return res;
+}
+
+int PpCode::slotCount()
+{
+    PpCodeTables* t = tables();
+    QMutexLocker lock(&t->d_lock);
+    return t->d_slots.size();
+}
+
+PpCode::PpVars PpCode::toSlots(const QHash<QByteArray,int>& vars)
+{
+    PpVars res;
+    QHash<QByteArray,int>::const_iterator i;
+    for( i = vars.begin(); i != vars.end(); ++i )
+    {
+        const int s = slot(i.key().toLower());
+        if( s >= res.size() )
+            res.resize(s+1);
+        res[s] = i.value();
+    }
+    return res;
+}
+
+quint32 PpCode::getHits()
+{
+    return tables()->d_hits;
+}
+
+quint32 PpCode::getMisses()
+{
+    return tables()->d_misses;
+}
+
+bool PpCode::apply(int op, qint32 lhs, qint32 rhs, qint32& res)
+{
+    switch( op )
+    {
+    case Add:
+        res = lhs + rhs;
+        break;
+    case Sub:
+        res = lhs - rhs;
+        break;
+    case Or:
+        res = lhs || rhs;
+        break;
+    case Mul:
+        res = lhs * rhs;
+        break;
+    case Div:
+        if( rhs == 0 )
+            return false;
+        res = lhs / rhs;
+        break;
+    case Mod:
+        if( rhs == 0 )
+            return false;
+        res = lhs % rhs;
+        break;
+    case And:
+        res = lhs && rhs;
+        break;
+    case Eq:
+        res = lhs == rhs;
+        break;
+    case Neq:
+        res = lhs != rhs;
+        break;
+    case Lt:
+        res = lhs < rhs;
+        break;
+    case Leq:
+        res = lhs <= rhs;
+        break;
+    case Gt:
+        res = lhs > rhs;
+        break;
+    case Geq:
+        res = lhs >= rhs;
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+bool PpCode::eval(const PpVars& vars, qint32& res) const
+{
+    QVarLengthArray<qint32,16> stack(d_depth);
+    int sp = 0;
+    const qint32* pc = d_ops.constData();
+    const qint32* end = pc + d_ops.size();
+    while( pc < end )
+    {
+        const int op = *pc++;
+        switch( op )
+        {
+        case Const:
+            stack[sp++] = *pc++;
+            break;
+        case Var:
+            {
+                const int slot = *pc++;
+                stack[sp++] = slot < vars.size() ? vars[slot] : 0;
+            }
+            break;
+        case Neg:
+            stack[sp-1] = -stack[sp-1];
+            break;
+        case Not:
+            stack[sp-1] = !stack[sp-1];
+            break;
+        default:
+            sp--;
+            if( !apply(op, stack[sp-1], stack[sp], stack[sp-1]) )
+                return false;
+            break;
+        }
+    }
+    Q_ASSERT( sp == 1 );
+    res = stack[0];
+    return true;
+}
+
+void PpLexer::trackInputs(const PpCode* code)
+{
+    foreach( qint32 slot, code->d_reads )
+    {
+        if( !d_assigned.contains(slot) && !d_inputs.contains(slot) )
+            d_inputs.insert(slot, slot < d_ppVars.size() ? d_ppVars[slot] : 0);
+    }
+}
+
+bool PpLexer::handleSetc(const QByteArray& data)
+{
+    PpCode::Ref code = PpCode::compile(data,true);
+    if( !code->d_err.isEmpty() )
+        return error(QString::fromUtf8(code->d_err));
+    trackInputs(code.data());
+    qint32 res;
+    if( !code->eval(d_ppVars,res) )
+        return error("division by zero in SETC expression");
+    if( code->d_target >= d_ppVars.size() )
+        d_ppVars.resize(PpCode::slotCount());
+    d_ppVars[code->d_target] = res;
+    d_assigned.insert(code->d_target);
     return true;
 }
 
 bool PpLexer::handleIfc(const QByteArray& data)
 {
-    QByteArray statement = data;
-    QBuffer buf(&statement);
-    buf.open(QIODevice::ReadOnly);
-    Lexer lex;
-    lex.setStream(&buf);
-    PpEval e(d_ppVars,lex);
-    if( !e.eval() )
-        return error(QString("%1 in SETC expression").arg(e.getErr().constData()));
+    PpCode::Ref code = PpCode::compile(data,false);
+    if( !code->d_err.isEmpty() )
+        return error(QString::fromUtf8(code->d_err));
+    trackInputs(code.data());
+    qint32 res;
+    if( !code->eval(d_ppVars,res) )
+        return error("division by zero in IFC expression");
 
-    const bool cond = e.getRes();
+    const bool cond = res;
     d_conditionStack.append( ppstatus(false) );
     ppsetthis( ppouter().open && cond );
     return true;
@@ -558,3 +894,108 @@ bool PpLexer::error(const QString& msg)
     return false;
 }
 
+
+IncludeCache::IncludeCache():d_bytes(0),d_limit(32*1024*1024),d_hits(0),d_misses(0)
+{
+}
+
+IncludeCache*IncludeCache::instance()
+{
+    static IncludeCache s_inst;
+    return &s_inst;
+}
+
+IncludeCache::Ref IncludeCache::fetch(FileSystem* fs, const FileSystem::File* f)
+{
+    Q_ASSERT( f );
+    qint64 size;
+    QDateTime modified;
+    quint32 crc = 0;
+    if( fs->isArchive() )
+    {
+        // archive members have virtual paths without file info; and a member is replaced when the
+        // archive is loaded again, so it is identified by the size and crc FileSystem::load recorded
+        size = f->d_size;
+        crc = f->d_crc;
+    }else
+    {
+        const QFileInfo info(f->d_realPath);
+        size = info.size();
+        modified = info.lastModified();
+    }
+    QMutexLocker lock(&d_lock);
+    QHash<QString,Ref>::const_iterator i = d_map.find(f->d_realPath);
+    if( i != d_map.end() && i.value()->d_size == size && i.value()->d_modified == modified &&
+            i.value()->d_crc == crc )
+    {
+        Ref res = i.value();
+        d_lru.removeOne(f->d_realPath);
+        d_lru.append(f->d_realPath);
+        d_hits++;
+        return res;
+    }
+    d_misses++;
+    lock.unlock();
+
+    // lex outside of the lock; if another thread does the same file concurrently the last one wins
+    QScopedPointer<QIODevice> in(fs->getStore()->open(f->d_realPath));
+    if( in.isNull() )
+        return Ref();
+    Entry* e = new Entry();
+    e->d_size = size;
+    e->d_modified = modified;
+    e->d_crc = crc;
+    Lexer lex;
+    lex.setIgnoreComments(false);
+    lex.setStream(in.data(),f->d_realPath);
+    Token t;
+    do
+    {
+        t = lex.nextToken();
+        e->d_toks.append(t);
+        e->d_bytes += sizeof(Token) + t.d_val.size();
+    }while( t.d_type != Tok_Eof );
+    e->d_sloc = lex.getSloc();
+    Ref res(e);
+
+    if( e->d_bytes > d_limit )
+        return res; // too big to be cached
+
+    lock.relock();
+    if( d_map.contains(f->d_realPath) )
+    {
+        d_bytes -= d_map.value(f->d_realPath)->d_bytes;
+        d_lru.removeOne(f->d_realPath);
+    }
+    d_map[f->d_realPath] = res;
+    d_lru.append(f->d_realPath);
+    d_bytes += e->d_bytes;
+    while( d_bytes > d_limit && !d_lru.isEmpty() )
+    {
+        // the entry stays valid for the PpLexer still replaying it
+        d_bytes -= d_map.take(d_lru.first())->d_bytes;
+        d_lru.pop_front();
+    }
+    return res;
+}
+
+void IncludeCache::setLimit(quint32 bytes)
+{
+    QMutexLocker lock(&d_lock);
+    d_limit = bytes;
+    while( d_bytes > d_limit && !d_lru.isEmpty() )
+    {
+        d_bytes -= d_map.take(d_lru.first())->d_bytes;
+        d_lru.pop_front();
+    }
+}
+
+void IncludeCache::clear()
+{
+    QMutexLocker lock(&d_lock);
+    d_map.clear();
+    d_lru.clear();
+    d_bytes = 0;
+    d_hits = 0;
+    d_misses = 0;
+}
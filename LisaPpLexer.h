@@ -20,6 +20,12 @@
 #include "LisaFileSystem.h"
 #include "LisaLexer.h"
 #include "LisaRowCol.h"
+#include <QDateTime>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QSharedPointer>
+#include <QVector>
 
 class QIODevice;
 
@@ -27,23 +33,91 @@ namespace Lisa
 {
 class FileSystem;
 
+class IncludeCache
+{
+public:
+    struct Entry
+    {
+        QList<Token> d_toks; // the raw token stream including comments, terminated by Tok_Eof
+        quint32 d_sloc;
+        qint64 d_size; // identity of the file at the time it was lexed
+        QDateTime d_modified;
+        quint32 d_crc; // of the content instead of d_modified for archive members
+        quint32 d_bytes; // estimated memory use
+        Entry():d_sloc(0),d_size(0),d_crc(0),d_bytes(0){}
+    };
+    typedef QSharedPointer<const Entry> Ref;
+
+    static IncludeCache* instance(); // shared by all PpLexer and threads
+    Ref fetch(FileSystem*, const FileSystem::File*); // lexes the file on a miss; null if the file cannot be read
+    void setLimit(quint32 bytes);
+    void clear();
+    quint32 getHits() const { return d_hits; }
+    quint32 getMisses() const { return d_misses; }
+    quint32 getBytes() const { return d_bytes; }
+private:
+    IncludeCache();
+    QMutex d_lock;
+    QHash<QString,Ref> d_map; // real path -> tokens
+    QList<QString> d_lru; // least recently used first
+    quint32 d_bytes, d_limit, d_hits, d_misses;
+};
+
+class PpCode
+{
+public:
+    // SETC and IFC expressions are compiled once per distinct directive text into a
+    // postfix program which refers to preprocessor variables by global slot number
+    enum Op { Const, Var, // followed by the value or slot
+              Neg, Not, Add, Sub, Or, Mul, Div, Mod, And, Eq, Neq, Lt, Leq, Gt, Geq };
+    typedef QVector<qint32> PpVars; // indexed by slot, missing slots read as 0
+    typedef QSharedPointer<const PpCode> Ref;
+
+    QVector<qint32> d_ops;
+    QVector<qint32> d_reads; // the distinct slots referenced by d_ops
+    qint32 d_target; // the slot assigned by SETC, -1 for IFC
+    quint16 d_depth; // max evaluation stack depth
+    QByteArray d_err; // compile error if not empty
+
+    static Ref compile(const QByteArray& directive, bool setc); // cached and thread-safe
+    static int slot(const QByteArray& lowerCaseName);
+    static int slotCount();
+    static PpVars toSlots(const QHash<QByteArray,int>& vars); // case insensitive names
+    static quint32 getHits();
+    static quint32 getMisses();
+    static bool apply(int op, qint32 lhs, qint32 rhs, qint32& res);
+    bool eval(const PpVars&, qint32& res) const; // false on division by zero
+    PpCode():d_target(-1),d_depth(0){}
+};
+
 class PpLexer
 {
 public:
     enum PpSym { PpNone, PpIncl, PpSetc, PpIfc, PpElsec, PpEndc };
-    typedef QHash<QByteArray,int> PpVars;
+    typedef PpCode::PpVars PpVars;
     struct Include
     {
         const FileSystem::File* d_inc; // the file to include
         QString d_sourcePath; // the file where the include lives
         RowCol d_loc; // the pos of the include directive in sourcePath
         quint16 d_len; // the len of the include directive
+        QString d_dir, d_name; // the include spec as looked up relative to sourcePath
     };
 
     PpLexer(FileSystem*);
     ~PpLexer();
 
     bool reset(const QString& filePath);
+    void setVars(const PpVars& preset) { d_preset = preset; } // the values before the first SETC, e.g. per configuration
+    const QMap<int,qint32>& getInputs() const { return d_inputs; } // slot -> value of each variable read before assigned
+
+    // checkpoints are recorded in the top level file (not in includes) every n lines, see Lexer
+    void setCheckpointInterval( quint16 lines ) { d_interval = lines; } // call before reset
+    int getCheckpointCount() const { return d_checkpoints.size(); }
+    quint32 getCheckpointLine( int i ) const { return d_checkpoints[i].d_lex.d_lineNr; }
+    quint32 getCheckpointToken( int i ) const { return d_checkpoints[i].d_tokens; } // index of the first token after resume
+    int findCheckpoint( quint32 lineNr ) const; // the last checkpoint at or before lineNr, or -1
+    bool resume( int checkpoint ); // continue with the tokens and preprocessor state of the checkpoint line
 
     Token nextToken();
     Token peekToken(quint8 lookAhead = 1);
@@ -58,6 +132,10 @@ protected:
     bool handleIfc(const QByteArray& data);
     bool handleElsec();
     bool handleEndc();
+    void trackInputs(const PpCode*);
+    bool openTop();
+    void closeAll();
+    void syncCheckpoints(bool skipped);
     bool error( const QString& msg);
 
     struct ppstatus
@@ -94,24 +172,74 @@ protected:
                 stat.openSeen = true;
         }
     }
+public:
+    struct Checkpoint
+    {
+        Lexer::Checkpoint d_lex;
+        quint32 d_tokens; // delivered before the checkpoint line
+        quint32 d_sloc;
+        PpVars d_vars;
+        QList<ppstatus> d_cond;
+        QMap<int,qint32> d_inputs;
+        QSet<int> d_assigned;
+        int d_includes;
+        Ranges d_mutes;
+        RowCol d_startMute;
+        bool d_skip; // the line was passed while skipping a muted region
+    };
+
+    const QList<Checkpoint>& getCheckpoints() const { return d_checkpoints; }
+    void setCheckpoints( const QList<Checkpoint>& cps ) { d_checkpoints = cps; } // of an earlier run on the file; call after reset
 private:
     struct Level
     {
-        Lexer d_lex;
+        Lexer d_lex; // only used for the top-level file; its device is a buffer from SourceStore::open owned by PpLexer
+        IncludeCache::Ref d_cached; // include files are replayed from the cache
+        int d_pos;
         Ranges d_mutes;
+        Token nextToken()
+        {
+            if( d_cached.isNull() )
+                return d_lex.nextToken();
+            return d_cached->d_toks[qMin(d_pos++, d_cached->d_toks.size()-1)];
+        }
+        Token peekToken()
+        {
+            if( d_cached.isNull() )
+                return d_lex.peekToken();
+            return d_cached->d_toks[qMin(d_pos, d_cached->d_toks.size()-1)];
+        }
+        void skipToComment()
+        {
+            if( d_cached.isNull() )
+                d_lex.skipToComment();
+            else
+                while( d_pos < d_cached->d_toks.size() - 1 &&
+                       d_cached->d_toks[d_pos].d_type != Tok_Comment && d_cached->d_toks[d_pos].d_type != Tok_Eof )
+                    d_pos++;
+        }
+        quint32 getSloc() const { return d_cached.isNull() ? d_lex.getSloc() : d_cached->d_sloc; }
+        Level():d_pos(0){}
     };
 
     FileSystem* d_fs;
+    QString d_path;
     QList<Level> d_stack;
-    QList<QIODevice*> d_files;
     QList<Token> d_buffer;
     QString d_err;
     quint32 d_sloc; // number of lines of code without empty or comment lines
     PpVars d_ppVars;
+    PpVars d_preset;
+    QMap<int,qint32> d_inputs;
+    QSet<int> d_assigned;
     QList<ppstatus> d_conditionStack;
     QList<Include> d_includes;
     QHash<QString,Ranges> d_mutes;
     RowCol d_startMute;
+    QList<Checkpoint> d_checkpoints;
+    quint16 d_interval;
+    quint32 d_lexSeen; // the line of the last checkpoint of the top level lexer already looked at
+    quint32 d_tokens; // number of tokens returned by nextTokenImp
 };
 }
 
@@ -0,0 +1,169 @@
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+#include "LisaPrefetcher.h"
+#include <QBuffer>
+#include <QFile>
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+using namespace Lisa;
+
+enum { ReaderCount = 2, AdviseAhead = 8 };
+
+class Prefetcher::Reader : public QRunnable
+{
+public:
+    Reader(Prefetcher* p):d_p(p){}
+    void run()
+    {
+        while( d_p->readNext() )
+            ;
+    }
+private:
+    Prefetcher* d_p;
+};
+
+Prefetcher::Prefetcher():d_bytes(0),d_limit(64*1024*1024),d_hits(0),d_misses(0),d_generation(0)
+{
+    d_pool.setMaxThreadCount(ReaderCount);
+}
+
+Prefetcher::~Prefetcher()
+{
+    cancel();
+    d_pool.waitForDone();
+}
+
+Prefetcher*Prefetcher::instance()
+{
+    static Prefetcher s_inst;
+    return &s_inst;
+}
+
+void Prefetcher::schedule(const QStringList& realPaths)
+{
+    QMutexLocker lock(&d_lock);
+    d_generation++;
+    d_queue = realPaths;
+    d_ready.clear();
+    d_bytes = 0;
+    d_hits = 0;
+    d_misses = 0;
+    d_changed.wakeAll();
+    const QStringList ahead = d_queue.mid(0, AdviseAhead);
+    lock.unlock();
+    for( int i = 0; i < ReaderCount; i++ )
+        d_pool.start(new Reader(this));
+    foreach( const QString& path, ahead )
+        advise(path);
+}
+
+void Prefetcher::cancel()
+{
+    QMutexLocker lock(&d_lock);
+    d_generation++;
+    d_queue.clear();
+    d_ready.clear();
+    d_bytes = 0;
+    d_changed.wakeAll();
+}
+
+void Prefetcher::setLimit(quint32 bytes)
+{
+    QMutexLocker lock(&d_lock);
+    d_limit = bytes;
+    d_changed.wakeAll();
+}
+
+QIODevice*Prefetcher::open(const QString& realPath)
+{
+    QMutexLocker lock(&d_lock);
+    while( d_reading.contains(realPath) )
+        d_changed.wait(&d_lock);
+    QHash<QString,QByteArray>::iterator i = d_ready.find(realPath);
+    if( i != d_ready.end() )
+    {
+        QBuffer* res = new QBuffer();
+        res->setData(i.value());
+        d_bytes -= i.value().size();
+        d_ready.erase(i);
+        d_hits++;
+        d_changed.wakeAll();
+        lock.unlock();
+        res->open(QIODevice::ReadOnly);
+        return res;
+    }
+    d_queue.removeOne(realPath); // read it here instead of waiting for the readers
+    d_misses++;
+    lock.unlock();
+
+    QFile* res = new QFile(realPath);
+    if( !res->open(QIODevice::ReadOnly) )
+    {
+        delete res;
+        return 0;
+    }
+    return res;
+}
+
+bool Prefetcher::readNext()
+{
+    QMutexLocker lock(&d_lock);
+    while( !d_queue.isEmpty() && d_bytes >= d_limit )
+        d_changed.wait(&d_lock); // until the lexers have claimed enough buffers
+    if( d_queue.isEmpty() )
+        return false;
+    const QString path = d_queue.takeFirst();
+    const quint32 gen = d_generation;
+    d_reading.insert(path);
+    const QString ahead = d_queue.value(AdviseAhead-1);
+    lock.unlock();
+    if( !ahead.isEmpty() )
+        advise(ahead);
+
+    QFile in(path);
+    QByteArray data;
+    const bool ok = in.open(QIODevice::ReadOnly);
+    if( ok )
+        data = in.readAll();
+
+    lock.relock();
+    d_reading.remove(path);
+    if( ok && gen == d_generation )
+    {
+        d_ready.insert(path,data);
+        d_bytes += data.size();
+    }
+    d_changed.wakeAll();
+    return true;
+}
+
+void Prefetcher::advise(const QString& realPath)
+{
+    // lets the kernel start reading the file into the page cache; called without d_lock, so the
+    // lexers waiting in open() don't wait for the system calls
+#if defined(Q_OS_UNIX) && defined(POSIX_FADV_WILLNEED)
+    const int fd = ::open(QFile::encodeName(realPath).constData(), O_RDONLY);
+    if( fd < 0 )
+        return;
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    ::close(fd);
+#else
+    Q_UNUSED(realPath);
+#endif
+}
@@ -0,0 +1,66 @@
+#ifndef LISAPREFETCHER_H
+#define LISAPREFETCHER_H
+
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+class QIODevice;
+
+namespace Lisa
+{
+// Reads the files which will be lexed next in background threads, so the lexers don't wait on I/O.
+// The files further ahead in the queue are announced to the kernel with posix_fadvise where available.
+class Prefetcher
+{
+public:
+    static Prefetcher* instance(); // shared by all lexers and threads
+
+    // replaces the queue and resets the statistics; unclaimed buffers of a previous schedule are dropped
+    void schedule(const QStringList& realPaths);
+    // a buffer with the prefetched content, or the opened file if not prefetched; the caller owns
+    // the device; null if the file cannot be opened
+    QIODevice* open(const QString& realPath);
+    void cancel();
+
+    void setLimit(quint32 bytes); // of the buffers read but not yet claimed
+    quint32 getHits() const { return d_hits; }
+    quint32 getMisses() const { return d_misses; }
+private:
+    Prefetcher();
+    ~Prefetcher();
+    class Reader;
+    friend class Reader;
+    bool readNext();
+    static void advise(const QString& realPath);
+    QMutex d_lock;
+    QWaitCondition d_changed;
+    QStringList d_queue;
+    QSet<QString> d_reading;
+    QHash<QString,QByteArray> d_ready;
+    QThreadPool d_pool;
+    quint32 d_bytes, d_limit, d_hits, d_misses;
+    quint32 d_generation; // incremented by each schedule and cancel
+};
+}
+
+#endif // LISAPREFETCHER_H
@@ -0,0 +1,156 @@
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+#include "LisaSourceStore.h"
+#include "LisaPrefetcher.h"
+#include "LisaArchive.h"
+#include <QBuffer>
+#include <QScopedPointer>
+using namespace Lisa;
+
+SourceStore::SourceStore():d_archive(0),d_files(0),d_reads(0),d_bytes(0)
+{
+
+}
+
+void SourceStore::put(const QString& realPath, const QByteArray& raw)
+{
+    const QByteArray data = normalize(raw);
+    QMutexLocker lock(&d_lock);
+    if( d_data.contains(realPath) )
+        return;
+    d_data.insert(realPath,data);
+    d_files++;
+    d_bytes += data.size();
+}
+
+QByteArray SourceStore::get(const QString& realPath)
+{
+    {
+        QMutexLocker lock(&d_lock);
+        QHash<QString,QByteArray>::const_iterator i = d_data.find(realPath);
+        if( i != d_data.end() )
+            return i.value();
+    }
+    // read outside of the lock; the prefetcher might already have the content
+    QByteArray raw;
+    if( d_archive && d_archive->contains(realPath) )
+    {
+        raw = d_archive->read(realPath);
+        if( raw.isNull() )
+            return QByteArray(); // corrupt member
+    }else
+    {
+        QScopedPointer<QIODevice> in(Prefetcher::instance()->open(realPath));
+        if( in.isNull() )
+            return QByteArray();
+        raw = in->readAll();
+    }
+    const QByteArray data = normalize(raw);
+    QMutexLocker lock(&d_lock);
+    QHash<QString,QByteArray>::const_iterator i = d_data.find(realPath);
+    if( i != d_data.end() )
+        return i.value(); // another thread was faster
+    d_data.insert(realPath,data);
+    d_files++;
+    d_reads++;
+    d_bytes += data.size();
+    return data;
+}
+
+bool SourceStore::contains(const QString& realPath)
+{
+    QMutexLocker lock(&d_lock);
+    return d_data.contains(realPath);
+}
+
+QIODevice*SourceStore::open(const QString& realPath)
+{
+    const QByteArray data = get(realPath);
+    if( data.isNull() )
+        return 0;
+    QBuffer* res = new QBuffer();
+    res->setData(data);
+    res->open(QIODevice::ReadOnly);
+    return res;
+}
+
+QString SourceStore::getText(const QString& realPath)
+{
+    {
+        QMutexLocker lock(&d_lock);
+        QHash<QString,QString>::const_iterator i = d_text.find(realPath);
+        if( i != d_text.end() )
+            return i.value();
+    }
+    QByteArray data = get(realPath);
+    if( data.endsWith('\n') )
+        data.chop(1);
+    const QString text = QString::fromLatin1(data);
+    QMutexLocker lock(&d_lock);
+    if( !d_text.contains(realPath) )
+    {
+        d_text.insert(realPath,text);
+        d_bytes += text.size() * sizeof(QChar);
+    }
+    return text;
+}
+
+void SourceStore::invalidate(const QString& realPath)
+{
+    QMutexLocker lock(&d_lock);
+    QHash<QString,QByteArray>::iterator i = d_data.find(realPath);
+    if( i != d_data.end() )
+    {
+        d_bytes -= i.value().size();
+        d_files--;
+        d_data.erase(i);
+    }
+    QHash<QString,QString>::iterator j = d_text.find(realPath);
+    if( j != d_text.end() )
+    {
+        d_bytes -= j.value().size() * sizeof(QChar);
+        d_text.erase(j);
+    }
+}
+
+void SourceStore::clear()
+{
+    QMutexLocker lock(&d_lock);
+    d_data.clear();
+    d_text.clear();
+    d_files = 0;
+    d_reads = 0;
+    d_bytes = 0;
+}
+
+QByteArray SourceStore::normalize(const QByteArray& raw)
+{
+    if( raw.isEmpty() )
+        return QByteArray(""); // not null, which means unreadable
+    if( raw.indexOf('\r') < 0 && raw.indexOf(char(0xff)) < 0 )
+        return raw;
+    QByteArray res;
+    res.reserve(raw.size());
+    for( int i = 0; i < raw.size(); i++ )
+    {
+        const char ch = raw[i];
+        if( ch == '\r' && i + 1 < raw.size() && raw[i+1] == '\n' )
+            continue;
+        res += ch == char(0xff) ? ' ' : ch;
+    }
+    return res;
+}
@@ -0,0 +1,60 @@
+#ifndef LISASOURCESTORE_H
+#define LISASOURCESTORE_H
+
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+class QIODevice;
+
+namespace Lisa
+{
+// The content of each source file, read once and shared by the lexers and the viewer. \r\n line
+// ends are normalized to \n (a lone \r is kept) and 0xff (white space for the lexers) to a blank.
+// The returned byte arrays are implicitly shared with the store, so handing them out doesn't copy.
+class Archive;
+
+class SourceStore
+{
+public:
+    SourceStore();
+    void setArchive(const Archive* a) { d_archive = a; } // files not yet stored are read from its members
+    void put(const QString& realPath, const QByteArray& raw); // content the caller has already read
+    QByteArray get(const QString& realPath); // reads the file or archive member on first use; null if unreadable
+    bool contains(const QString& realPath);
+    QIODevice* open(const QString& realPath); // a buffer on get() owned by the caller; null if unreadable
+    QString getText(const QString& realPath); // Latin-1 decoded without the final line end, for display
+    void invalidate(const QString& realPath); // the file changed and will be read again on next use
+    void clear();
+
+    quint32 getFiles() const { return d_files; }
+    quint32 getReads() const { return d_reads; } // files read by the store itself
+    quint32 getBytes() const { return d_bytes; } // memory use of the content and the texts
+
+    static QByteArray normalize(const QByteArray& raw);
+private:
+    QMutex d_lock; // the lexers of parallel parsers share the store
+    const Archive* d_archive;
+    QHash<QString,QByteArray> d_data;
+    QHash<QString,QString> d_text;
+    quint32 d_files, d_reads, d_bytes;
+};
+}
+
+#endif // LISASOURCESTORE_H
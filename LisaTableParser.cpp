@@ -0,0 +1,165 @@
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+#include "LisaTableParser.h"
+#include <string.h>
+using namespace Lisa;
+
+namespace
+{
+// s_code: OpNode rule | OpExpect tok pkw name | OpCall addr | OpJumpIfNot cond addr | OpJump addr |
+//         OpInvalid name | OpRet
+enum Op { OpNode, OpExpect, OpCall, OpJumpIfNot, OpJump, OpInvalid, OpRet };
+// s_conds, postfix: CondIn k set pushes whether peek(k) is in the set
+enum Cond { CondIn, CondNot, CondAnd, CondOr, CondEnd };
+enum { SetEnd = 0xffff };
+
+#include "LisaParserTables.h"
+
+enum { Words = TT_Max / 64 + 1 };
+
+struct Bits
+{
+    quint64 d_words[SetCount][Words];
+    Bits()
+    {
+        ::memset(d_words, 0, sizeof(d_words));
+        int set = 0;
+        for( int i = 0; set < SetCount; i++ )
+        {
+            if( s_sets[i] == SetEnd )
+                set++;
+            else
+                d_words[set][s_sets[i] / 64] |= quint64(1) << (s_sets[i] % 64);
+        }
+    }
+};
+}
+
+TableParser::TableParser(Scanner* s):Parser(s)
+{
+    static const Bits bits;
+    d_bits = &bits.d_words[0][0];
+}
+
+void TableParser::RunParser()
+{
+    root = SynTree();
+    errors.clear();
+    next();
+    run(0); // the start rule
+}
+
+bool TableParser::RunRule(quint16 rule)
+{
+    for( int i = 0; i < RuleCount; i++ )
+    {
+        if( s_rules[2*i] == rule )
+        {
+            root = SynTree();
+            errors.clear();
+            next();
+            run(s_rules[2*i+1]);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TableParser::run(quint16 pc)
+{
+    SynTree* st = &root;
+    d_stack.clear();
+    while( true )
+    {
+        switch( s_code[pc] )
+        {
+        case OpNode:
+            {
+                SynTree* tmp = new SynTree(s_code[pc+1], la);
+                st->d_children.append(tmp);
+                st = tmp;
+                pc += 2;
+            }
+            break;
+        case OpExpect:
+            if( expect(s_code[pc+1], s_code[pc+2], s_names[s_code[pc+3]]) )
+                addTerminal(st);
+            pc += 4;
+            break;
+        case OpCall:
+            d_stack.append(Frame(pc+2,st));
+            pc = s_code[pc+1];
+            break;
+        case OpJumpIfNot:
+            pc = test(s_code[pc+1]) ? pc + 3 : s_code[pc+2];
+            break;
+        case OpJump:
+            pc = s_code[pc+1];
+            break;
+        case OpInvalid:
+            invalid(s_names[s_code[pc+1]]);
+            pc += 2;
+            break;
+        case OpRet:
+            if( d_stack.isEmpty() )
+                return;
+            pc = d_stack.last().d_pc;
+            st = d_stack.last().d_st;
+            d_stack.pop_back();
+            break;
+        }
+    }
+}
+
+bool TableParser::test(quint16 cond)
+{
+    bool stack[16];
+    int sp = 0;
+    for( const quint16* c = s_conds + s_condStart[cond]; ; )
+    {
+        switch( *c )
+        {
+        case CondIn:
+            {
+                Q_ASSERT( sp < 16 );
+                const quint16 tt = c[1] == 1 ? la.d_type : peek(c[1]).d_type;
+                const quint64* set = d_bits + c[2] * Words;
+                stack[sp++] = tt < TT_Max && ( set[tt / 64] & ( quint64(1) << (tt % 64) ) );
+                c += 3;
+            }
+            break;
+        case CondNot:
+            stack[sp-1] = !stack[sp-1];
+            c++;
+            break;
+        case CondAnd:
+            sp--;
+            stack[sp-1] = stack[sp-1] && stack[sp];
+            c++;
+            break;
+        case CondOr:
+            sp--;
+            stack[sp-1] = stack[sp-1] || stack[sp];
+            c++;
+            break;
+        case CondEnd:
+            Q_ASSERT( sp == 1 );
+            return stack[0];
+        }
+    }
+    return false;
+}
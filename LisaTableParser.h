@@ -0,0 +1,55 @@
+#ifndef LISATABLEPARSER_H
+#define LISATABLEPARSER_H
+
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+#include <LisaPascal/LisaParser.h>
+#include <QVector>
+
+namespace Lisa
+{
+// Table driven variant of the generated recursive descent Parser; it interprets the tables in
+// LisaParserTables.h (see syntax/ParserTables.py) with an explicit stack instead of the native
+// call stack, and produces the same SynTree and errors as Parser.
+class TableParser : public Parser
+{
+public:
+    TableParser(Scanner* s);
+    void RunParser();
+    bool RunRule(quint16 rule); // parses a single SynTree::R_* instead of a file; false if there is no such rule
+private:
+    void run(quint16 pc);
+    bool test(quint16 cond);
+    struct Frame
+    {
+        quint16 d_pc; // where to continue in the caller
+        SynTree* d_st;
+        Frame(quint16 pc = 0, SynTree* st = 0):d_pc(pc),d_st(st){}
+    };
+    QVector<Frame> d_stack;
+    const quint64* d_bits;
+};
+
+// Selects the parser used by the code model and the tools at compile time
+#ifdef LISA_TABLE_PARSER
+typedef TableParser PascalParser;
+#else
+typedef Parser PascalParser;
+#endif
+}
+
+#endif // LISATABLEPARSER_H
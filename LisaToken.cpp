@@ -16,19 +16,54 @@
 */
 
 #include "LisaToken.h"
+#include "AsmToken.h"
 #include <QHash>
+#include <QReadWriteLock>
 #include <QtDebug>
 
 static QHash<QByteArray,QByteArray> d_symbols;
+static QReadWriteLock d_lock; // the assembler files are lexed in parallel; most ids are already known
 
 
 const char* Lisa::Token::toId(const QByteArray& ident)
 {
-    if( ident.isEmpty() )
+    return toId(ident.constData(), ident.size());
+}
+
+const char* Lisa::Token::toId(const char* ident, int len)
+{
+    if( len <= 0 )
         return "";
-    const QByteArray lc = ident.toLower();
-    QByteArray& sym = d_symbols[lc];
+    char buf[128];
+    QByteArray lc;
+    bool ascii = len <= int(sizeof(buf));
+    for( int i = 0; i < len && ascii; i++ )
+    {
+        const char ch = ident[i];
+        if( ch & 0x80 )
+            ascii = false;
+        else
+            buf[i] = ch >= 'A' && ch <= 'Z' ? ch + ( 'a' - 'A' ) : ch;
+    }
+    if( ascii )
+        lc = QByteArray::fromRawData(buf, len);
+    else
+        lc = QByteArray(ident, len).toLower();
+    {
+        QReadLocker lock(&d_lock);
+        QHash<QByteArray,QByteArray>::const_iterator i = d_symbols.constFind(lc);
+        if( i != d_symbols.constEnd() )
+            return i.value().constData();
+    }
+    QWriteLocker lock(&d_lock);
+    const QByteArray key(lc.constData(), lc.size()); // a deep copy; a copy of lc would still refer to buf
+    QByteArray& sym = d_symbols[key];
     if( sym.isEmpty() )
-        sym = lc;
+        sym = key;
     return sym.constData();
 }
+
+const char* Asm::Token::toId(const char* ident, int len)
+{
+    return Lisa::Token::toId(ident, len);
+}
@@ -48,6 +48,7 @@ namespace Lisa
         RowCol toLoc() const { return RowCol(d_lineNr,d_colNr); }
 
         static const char* toId(const QByteArray& ident);
+        static const char* toId(const char* ident, int len); // only allocates for new ids; thread safe
     };
 }
 
@@ -0,0 +1,125 @@
+#ifndef LISATOKENSTREAM_H
+#define LISATOKENSTREAM_H
+
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+// Reader for the preprocessed token streams written by "LisaPascal -tok <dir>".
+// This header is self-contained and doesn't depend on Qt, so external tools can just copy it.
+//
+// A stream file contains the tokens of one unit after include and SETC/IFC processing, without
+// comments. All integers are little endian and all parts are 4 byte aligned, so the file can be
+// memory mapped and used in place on little endian machines:
+//
+//   Header
+//   File[fileCount]   the unit and its include files, paths relative to the exported root
+//   Tok[tokenCount]
+//   char[poolSize]    path and token value strings, not zero terminated
+//
+// Tok::type is the Lisa::TokenType of LisaTokenType.h of the exporting version, which is
+// also identified by Header::version.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+namespace Lisa
+{
+namespace TokStream
+{
+    enum { Version = 1 };
+
+    struct Header
+    {
+        char magic[4]; // "LTOK"
+        uint32_t version;
+        uint32_t fileCount;
+        uint32_t tokenCount;
+        uint32_t poolSize;
+    };
+
+    struct Str
+    {
+        uint32_t off; // into the pool
+        uint32_t len;
+    };
+
+    struct File
+    {
+        Str path;
+    };
+
+    struct Tok
+    {
+        uint16_t type;
+        uint16_t file; // index into the file table
+        uint32_t line;
+        uint16_t col;
+        uint16_t len; // of the token in the source
+        Str val;
+    };
+
+    class Reader
+    {
+    public:
+        Reader():d_hdr(0),d_files(0),d_toks(0),d_pool(0){}
+
+        // data must stay valid as long as the reader is used
+        bool open(const void* data, size_t size)
+        {
+            d_hdr = 0;
+            if( size < sizeof(Header) )
+                return false;
+            const Header* h = static_cast<const Header*>(data);
+            if( ::memcmp(h->magic, "LTOK", 4) != 0 || h->version != Version )
+                return false;
+            const size_t need = sizeof(Header) + size_t(h->fileCount) * sizeof(File) +
+                    size_t(h->tokenCount) * sizeof(Tok) + h->poolSize;
+            if( size < need )
+                return false;
+            d_hdr = h;
+            d_files = reinterpret_cast<const File*>(h + 1);
+            d_toks = reinterpret_cast<const Tok*>(d_files + h->fileCount);
+            d_pool = reinterpret_cast<const char*>(d_toks + h->tokenCount);
+            return true;
+        }
+        bool isOpen() const { return d_hdr != 0; }
+
+        uint32_t getFileCount() const { return d_hdr ? d_hdr->fileCount : 0; }
+        uint32_t getTokenCount() const { return d_hdr ? d_hdr->tokenCount : 0; }
+        const Tok& getToken(uint32_t i) const { return d_toks[i]; }
+        const Tok* begin() const { return d_toks; }
+        const Tok* end() const { return d_toks + getTokenCount(); }
+
+        // the returned strings are not zero terminated; use the length
+        const char* getFilePath(uint32_t i, uint32_t* len) const { return str(d_files[i].path, len); }
+        const char* getValue(const Tok& t, uint32_t* len) const { return str(t.val, len); }
+    private:
+        const char* str(const Str& s, uint32_t* len) const
+        {
+            if( len )
+                *len = s.len;
+            return d_pool + s.off;
+        }
+        const Header* d_hdr;
+        const File* d_files;
+        const Tok* d_toks;
+        const char* d_pool;
+    };
+}
+}
+
+#endif // LISATOKENSTREAM_H
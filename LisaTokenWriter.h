@@ -0,0 +1,104 @@
+#ifndef LISATOKENWRITER_H
+#define LISATOKENWRITER_H
+
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+#include <QFile>
+#include <QHash>
+#include <QtEndian>
+#include "LisaToken.h"
+#include "LisaTokenStream.h"
+
+namespace Lisa
+{
+// Writes the format of LisaTokenStream.h; the file paths are stored relative to root.
+class TokStreamWriter
+{
+public:
+    TokStreamWriter(const QString& root):d_root(root),d_count(0){}
+
+    void add(const Token& t)
+    {
+        QHash<QString,quint16>::const_iterator i = d_fileIdx.find(t.d_sourcePath);
+        if( i == d_fileIdx.end() )
+        {
+            i = d_fileIdx.insert(t.d_sourcePath, d_files.size());
+            d_files.append( str(t.d_sourcePath.mid(d_root.size()).toUtf8()) );
+        }
+        const TokStream::Str val = str(t.d_val);
+        TokStream::Tok tok;
+        tok.type = qToLittleEndian<quint16>(t.d_type);
+        tok.file = qToLittleEndian<quint16>(i.value());
+        tok.line = qToLittleEndian<quint32>(t.d_lineNr);
+        tok.col = qToLittleEndian<quint16>(t.d_colNr);
+        tok.len = qToLittleEndian<quint16>(t.d_len);
+        tok.val.off = qToLittleEndian<quint32>(val.off);
+        tok.val.len = qToLittleEndian<quint32>(val.len);
+        d_toks.append((const char*)&tok, sizeof(tok));
+        d_count++;
+    }
+    quint32 getTokenCount() const { return d_count; }
+
+    bool write(const QString& path)
+    {
+        QFile out(path);
+        if( !out.open(QIODevice::WriteOnly) )
+            return false;
+        while( d_pool.size() % 4 )
+            d_pool += char(0);
+        TokStream::Header h;
+        ::memcpy(h.magic, "LTOK", 4);
+        h.version = qToLittleEndian<quint32>(TokStream::Version);
+        h.fileCount = qToLittleEndian<quint32>(d_files.size());
+        h.tokenCount = qToLittleEndian<quint32>(d_count);
+        h.poolSize = qToLittleEndian<quint32>(d_pool.size());
+        out.write((const char*)&h, sizeof(h));
+        foreach( const TokStream::Str& f, d_files )
+        {
+            TokStream::File file;
+            file.path.off = qToLittleEndian<quint32>(f.off);
+            file.path.len = qToLittleEndian<quint32>(f.len);
+            out.write((const char*)&file, sizeof(file));
+        }
+        out.write(d_toks);
+        out.write(d_pool);
+        return true;
+    }
+private:
+    TokStream::Str str(const QByteArray& s)
+    {
+        QHash<QByteArray,TokStream::Str>::const_iterator i = d_strs.find(s);
+        if( i != d_strs.end() )
+            return i.value();
+        TokStream::Str res;
+        res.off = d_pool.size();
+        res.len = s.size();
+        d_pool += s;
+        d_strs.insert(s,res);
+        return res;
+    }
+    QString d_root;
+    QByteArray d_pool;
+    QHash<QByteArray,TokStream::Str> d_strs;
+    QHash<QString,quint16> d_fileIdx;
+    QList<TokStream::Str> d_files;
+    QByteArray d_toks;
+    quint32 d_count;
+};
+}
+
+#endif // LISATOKENWRITER_H
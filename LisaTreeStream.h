@@ -0,0 +1,148 @@
+#ifndef LISATREESTREAM_H
+#define LISATREESTREAM_H
+
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+// View of the syntax trees written by "LisaPascal -syn <dir>" and "LisaAsm -syn <dir>".
+// This header is self-contained and doesn't depend on Qt, so external tools can just copy it.
+//
+// A tree file contains the Lisa::SynTree or Asm::SynTree of one file in preorder. All integers
+// are little endian and all parts are 4 byte aligned, so the file can be memory mapped and used
+// in place on little endian machines:
+//
+//   Header
+//   Str[nameCount]    the name of each token type and rule, indexed by Node::type
+//   File[fileCount]   the file and its include files, paths relative to the exported root
+//   Node[nodeCount]
+//   char[poolSize]    name, path and token value strings, not zero terminated
+//
+// Node::type is a token type if less than Header::firstRule, otherwise a rule id; in both cases
+// of the exporting version. The subtree of node i are the nodes [i+1,Node::end), so the children
+// of i are visited by
+//
+//   for( uint32_t c = i + 1; c < view.getNode(i).end; c = view.getNode(c).end )
+//
+// Node::line, col and len are the position and source length of the token like TokStream::Tok;
+// a rule starts at its first token and has len 0, its last token is getNode(end - 1).
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+namespace Lisa
+{
+namespace TreeStream
+{
+    enum { Version = 2 };
+
+    struct Header
+    {
+        char magic[4]; // "LSYN"
+        uint32_t version;
+        uint32_t firstRule;
+        uint32_t nameCount;
+        uint32_t fileCount;
+        uint32_t nodeCount;
+        uint32_t poolSize;
+    };
+
+    struct Str
+    {
+        uint32_t off; // into the pool
+        uint32_t len;
+    };
+
+    struct File
+    {
+        Str path;
+    };
+
+    struct Node
+    {
+        uint16_t type;
+        uint16_t file; // index into the file table
+        uint32_t line;
+        uint16_t col;
+        uint16_t len; // of the token in the source, 0 for rules
+        Str val; // empty for rules and keywords
+        uint32_t end; // index of the node following the subtree
+    };
+
+    class View
+    {
+    public:
+        View():d_hdr(0),d_names(0),d_files(0),d_nodes(0),d_pool(0){}
+
+        // data must stay valid as long as the view is used
+        bool open(const void* data, size_t size)
+        {
+            d_hdr = 0;
+            if( size < sizeof(Header) )
+                return false;
+            const Header* h = static_cast<const Header*>(data);
+            if( ::memcmp(h->magic, "LSYN", 4) != 0 || h->version != Version )
+                return false;
+            const size_t need = sizeof(Header) + size_t(h->nameCount) * sizeof(Str) +
+                    size_t(h->fileCount) * sizeof(File) + size_t(h->nodeCount) * sizeof(Node) + h->poolSize;
+            if( size < need )
+                return false;
+            d_hdr = h;
+            d_names = reinterpret_cast<const Str*>(h + 1);
+            d_files = reinterpret_cast<const File*>(d_names + h->nameCount);
+            d_nodes = reinterpret_cast<const Node*>(d_files + h->fileCount);
+            d_pool = reinterpret_cast<const char*>(d_nodes + h->nodeCount);
+            return true;
+        }
+        bool isOpen() const { return d_hdr != 0; }
+
+        uint32_t getNodeCount() const { return d_hdr ? d_hdr->nodeCount : 0; }
+        uint32_t getFileCount() const { return d_hdr ? d_hdr->fileCount : 0; }
+        const Node& getNode(uint32_t i) const { return d_nodes[i]; } // 0 is the root
+        bool isRule(const Node& n) const { return n.type >= d_hdr->firstRule; }
+        bool isLeaf(uint32_t i) const { return d_nodes[i].end == i + 1; }
+        const Node& getLast(uint32_t i) const { return d_nodes[d_nodes[i].end - 1]; } // end position of i
+
+        // the returned strings are not zero terminated; use the length
+        const char* getName(uint16_t type, uint32_t* len) const
+        {
+            if( type >= d_hdr->nameCount )
+            {
+                if( len )
+                    *len = 0;
+                return d_pool;
+            }
+            return str(d_names[type], len);
+        }
+        const char* getFilePath(uint32_t i, uint32_t* len) const { return str(d_files[i].path, len); }
+        const char* getValue(const Node& n, uint32_t* len) const { return str(n.val, len); }
+    private:
+        const char* str(const Str& s, uint32_t* len) const
+        {
+            if( len )
+                *len = s.len;
+            return d_pool + s.off;
+        }
+        const Header* d_hdr;
+        const Str* d_names;
+        const File* d_files;
+        const Node* d_nodes;
+        const char* d_pool;
+    };
+}
+}
+
+#endif // LISATREESTREAM_H
@@ -0,0 +1,132 @@
+#ifndef LISATREEWRITER_H
+#define LISATREEWRITER_H
+
+/*
+** Copyright (C) 2023 Rochus Keller (me@rochus-keller.ch)
+**
+** This file is part of the LisaPascal project.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+*/
+
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QtEndian>
+#include "LisaTreeStream.h"
+
+namespace Lisa
+{
+// Writes the format of LisaTreeStream.h; works for Lisa::SynTree and Asm::SynTree.
+// Nodes are appended when begun and closed by end(), so a tree can also be emitted while it is built.
+class TreeStreamWriter
+{
+public:
+    TreeStreamWriter(const QString& root, quint32 firstRule, const QList<QByteArray>& names):
+        d_root(root),d_firstRule(firstRule)
+    {
+        foreach( const QByteArray& n, names )
+            d_names.append(str(n));
+    }
+
+    void begin(quint16 type, const QString& path, quint32 line, quint16 col, quint16 len, const QByteArray& val)
+    {
+        QHash<QString,quint16>::const_iterator i = d_fileIdx.find(path);
+        if( i == d_fileIdx.end() )
+        {
+            i = d_fileIdx.insert(path, d_files.size());
+            d_files.append( str(path.mid(d_root.size()).toUtf8()) );
+        }
+        TreeStream::Node n;
+        n.type = qToLittleEndian<quint16>(type);
+        n.file = qToLittleEndian<quint16>(i.value());
+        n.line = qToLittleEndian<quint32>(line);
+        n.col = qToLittleEndian<quint16>(col);
+        n.len = qToLittleEndian<quint16>(len);
+        const TreeStream::Str s = str(val);
+        n.val.off = qToLittleEndian<quint32>(s.off);
+        n.val.len = qToLittleEndian<quint32>(s.len);
+        n.end = 0;
+        d_open.append(d_nodes.size());
+        d_nodes.append(n);
+    }
+    void end()
+    {
+        Q_ASSERT( !d_open.isEmpty() );
+        d_nodes[d_open.last()].end = qToLittleEndian<quint32>(d_nodes.size());
+        d_open.pop_back();
+    }
+    template<class T>
+    void add(const T* st)
+    {
+        const bool rule = st->d_tok.d_type >= d_firstRule;
+        begin(st->d_tok.d_type, st->d_tok.d_sourcePath, st->d_tok.d_lineNr, st->d_tok.d_colNr,
+              rule ? 0 : st->d_tok.d_len, rule ? QByteArray() : st->d_tok.d_val);
+        foreach( T* sub, st->d_children )
+            add(sub);
+        end();
+    }
+    int getNodeCount() const { return d_nodes.size(); }
+
+    bool write(const QString& path)
+    {
+        Q_ASSERT( d_open.isEmpty() );
+        QFile out(path);
+        if( !out.open(QIODevice::WriteOnly) )
+            return false;
+        while( d_pool.size() % 4 )
+            d_pool += char(0);
+        TreeStream::Header h;
+        ::memcpy(h.magic, "LSYN", 4);
+        h.version = qToLittleEndian<quint32>(TreeStream::Version);
+        h.firstRule = qToLittleEndian<quint32>(d_firstRule);
+        h.nameCount = qToLittleEndian<quint32>(d_names.size());
+        h.fileCount = qToLittleEndian<quint32>(d_files.size());
+        h.nodeCount = qToLittleEndian<quint32>(d_nodes.size());
+        h.poolSize = qToLittleEndian<quint32>(d_pool.size());
+        out.write((const char*)&h, sizeof(h));
+        foreach( const TreeStream::Str& s, d_names + d_files )
+        {
+            TreeStream::Str le;
+            le.off = qToLittleEndian<quint32>(s.off);
+            le.len = qToLittleEndian<quint32>(s.len);
+            out.write((const char*)&le, sizeof(le));
+        }
+        out.write((const char*)d_nodes.constData(), d_nodes.size() * sizeof(TreeStream::Node));
+        out.write(d_pool);
+        return true;
+    }
+private:
+    TreeStream::Str str(const QByteArray& s)
+    {
+        QHash<QByteArray,TreeStream::Str>::const_iterator i = d_strs.find(s);
+        if( i != d_strs.end() )
+            return i.value();
+        TreeStream::Str res;
+        res.off = d_pool.size();
+        res.len = s.size();
+        d_pool += s;
+        d_strs.insert(s,res);
+        return res;
+    }
+    QString d_root;
+    quint32 d_firstRule;
+    QByteArray d_pool;
+    QHash<QByteArray,TreeStream::Str> d_strs;
+    QHash<QString,quint16> d_fileIdx;
+    QList<TreeStream::Str> d_names;
+    QList<TreeStream::Str> d_files;
+    QVector<TreeStream::Node> d_nodes;
+    QList<quint32> d_open; // indices of the nodes begun but not yet ended
+};
+}
+
+#endif // LISATREEWRITER_H
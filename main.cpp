@@ -21,40 +21,30 @@
 #include <QCryptographicHash>
 #include <QElapsedTimer>
 #include "LisaPpLexer.h"
-#include "LisaParser.h"
+#include "LisaPrefetcher.h"
+#include "LisaTableParser.h"
 #include "Converter.h"
 #include "LisaFileSystem.h"
+#include "LisaFileIndex.h"
+#include "LisaTokenWriter.h"
+#include "LisaTreeWriter.h"
+#include "LisaCodeModel.h"
+#include <QtEndian>
 using namespace Lisa;
 
-static void dump(QTextStream& out, const SynTree* node, int level)
+static QList<QByteArray> treeNames()
 {
-    QByteArray str;
-    if( node->d_tok.d_type == Tok_Invalid )
-        level--;
-    else if( node->d_tok.d_type < SynTree::R_First )
-    {
-        if( tokenTypeIsKeyword( node->d_tok.d_type ) )
-            str = tokenTypeString(node->d_tok.d_type);
-        else if( node->d_tok.d_type > TT_Specials )
-            str = QByteArray("\"") + node->d_tok.d_val + QByteArray("\"");
+    QList<QByteArray> res;
+    for( int i = 0; i < SynTree::R_Last; i++ )
+    {
+        if( i < TT_Max )
+            res << tokenTypeString(i);
+        else if( i > SynTree::R_First )
+            res << SynTree::rToStr(i);
         else
-            str = QByteArray("\"") + tokenTypeString(node->d_tok.d_type) + QByteArray("\"");
-
-    }else
-        str = SynTree::rToStr( node->d_tok.d_type );
-    if( !str.isEmpty() )
-    {
-        str += QByteArray("\t") + QFileInfo(node->d_tok.d_sourcePath).baseName().toUtf8() +
-                ":" + QByteArray::number(node->d_tok.d_lineNr) +
-                ":" + QByteArray::number(node->d_tok.d_colNr);
-        QByteArray ws;
-        for( int i = 0; i < level; i++ )
-            ws += "|  ";
-        str = ws + str;
-        out << str.data() << endl;
-    }
-    foreach( SynTree* sub, node->d_children )
-        dump( out, sub, level + 1 );
+            res << QByteArray();
+    }
+    return res;
 }
 
 static void compareFiles( const QStringList& files, int off )
@@ -109,7 +99,7 @@ static void checkDir( const QStringList& files, int off)
 
 #define _USE_EBNF_STUDIO_PARSER_
 
-class Lex
+class PpScanner
         #ifdef _USE_EBNF_STUDIO_PARSER_
         : public Scanner
         #endif
@@ -126,7 +116,7 @@ public:
         return lex.peekToken(offset);
     }
 
-    Lex(FileSystem*fs):lex(fs){}
+    PpScanner(FileSystem*fs):lex(fs){}
 };
 
 static void runParser(const QString& root)
@@ -136,16 +126,23 @@ static void runParser(const QString& root)
     // fs.getRoot().dump();
 
     QList<const FileSystem::File*> files = fs.getAllPas();
+    QStringList order;
+    foreach( const FileSystem::File* file, files )
+    {
+        if( !fs.getStore()->contains(file->d_realPath) )
+            order << file->d_realPath;
+    }
+    Prefetcher::instance()->schedule(order);
     int ok = 0;
     QElapsedTimer timer;
     timer.start();
     foreach( const FileSystem::File* file, files )
     {
         const QString path = file->getVirtualPath();
-        Lex lex(&fs);
+        PpScanner lex(&fs);
         lex.lex.reset(file->d_realPath);
 #ifdef _USE_EBNF_STUDIO_PARSER_
-        Parser p(&lex);
+        PascalParser p(&lex);
 #else
         Parser p(&lex.lex);
 #endif
@@ -162,19 +159,16 @@ static void runParser(const QString& root)
             ok++;
             qDebug() << "ok";
         }
-#if 0
-        QFile out(file->d_realPath + ".st");
-        out.open(QIODevice::WriteOnly);
-        QTextStream s(&out);
-#ifdef _USE_EBNF_STUDIO_PARSER_
-    dump(s,&p.root,0);
-#else
-    dump(s,&p.d_root,0);
-#endif
-#endif
     }
     qDebug() << "#### finished with" << ok << "files ok of total" << files.size() << "files"
              << "in" << timer.elapsed() << " [ms]";
+    qDebug() << "#### include cache" << IncludeCache::instance()->getHits() << "hits"
+             << IncludeCache::instance()->getMisses() << "misses" << IncludeCache::instance()->getBytes() << "bytes";
+    qDebug() << "#### include lookups" << fs.getLookups() << "of which" << fs.getLookupHits() << "memoized";
+    qDebug() << "#### prefetched" << Prefetcher::instance()->getHits() << "files," << Prefetcher::instance()->getMisses()
+             << "read on demand";
+    qDebug() << "#### source store" << fs.getStore()->getFiles() << "files" << fs.getStore()->getBytes() << "bytes"
+             << fs.getStore()->getReads() << "files read after load";
 }
 
 static void runParser(const QString& root, const QString& path)
@@ -182,10 +176,10 @@ static void runParser(const QString& root, const QString& path)
     FileSystem fs;
     fs.load(root);
 
-    Lex lex(&fs);
+    PpScanner lex(&fs);
     lex.lex.reset(path);
 #ifdef _USE_EBNF_STUDIO_PARSER_
-    Parser p(&lex);
+    PascalParser p(&lex);
 #else
     Parser p(&lex.lex);
 #endif
@@ -201,16 +195,502 @@ static void runParser(const QString& root, const QString& path)
     {
         qDebug() << "ok";
     }
-#if 0
-    QFile out(path + ".st");
-    out.open(QIODevice::WriteOnly);
-    QTextStream s(&out);
-#ifdef _USE_EBNF_STUDIO_PARSER_
-    dump(s,&p.root,0);
-#else
-    dump(s,&p.d_root,0);
-#endif
-#endif
+}
+
+static void runPreprocessor(const QString& root)
+{
+    // measures the preprocessor alone, without parser
+    FileSystem fs;
+    fs.load(root);
+
+    QList<const FileSystem::File*> files = fs.getAllPas();
+    quint32 toks = 0, sloc = 0, errs = 0;
+    QElapsedTimer timer;
+    timer.start();
+    foreach( const FileSystem::File* file, files )
+    {
+        PpLexer lex(&fs);
+        lex.reset(file->d_realPath);
+        Token t = lex.nextToken();
+        while( t.d_type != Tok_Eof )
+        {
+            if( t.d_type == Tok_Invalid )
+                errs++;
+            toks++;
+            t = lex.nextToken();
+        }
+        sloc += lex.getSloc();
+    }
+    qDebug() << "#### preprocessed" << files.size() << "files with" << sloc << "SLOC and" << toks << "tokens in"
+             << timer.elapsed() << "[ms]," << errs << "errors";
+    qDebug() << "#### directive cache" << PpCode::getHits() << "hits" << PpCode::getMisses() << "misses"
+             << PpCode::slotCount() << "variables";
+}
+
+static void collectDecls(const SynTree* st, QSet<QByteArray>& out, const QByteArray& outer = QByteArray())
+{
+    QByteArray name;
+    switch( st->d_tok.d_type )
+    {
+    case SynTree::R_constant_declaration:
+    case SynTree::R_type_declaration:
+    case SynTree::R_variable_declaration:
+    case SynTree::R_procedure_heading:
+    case SynTree::R_function_heading:
+        foreach( const SynTree* sub, st->d_children )
+        {
+            if( sub->d_tok.d_type == Tok_identifier )
+                name += ( name.isEmpty() ? "" : "." ) + sub->d_tok.d_val;
+            else if( sub->d_tok.d_type == SynTree::R_identifier_list )
+            {
+                foreach( const SynTree* id, sub->d_children )
+                    if( id->d_tok.d_type == Tok_identifier )
+                        out << outer + id->d_tok.d_val;
+            }
+        }
+        if( !name.isEmpty() )
+            out << outer + name;
+        break;
+    case SynTree::R_procedure_declaration:
+    case SynTree::R_function_declaration:
+        // locals are qualified by the routine
+        foreach( const SynTree* sub, st->d_children )
+        {
+            if( sub->d_tok.d_type != SynTree::R_procedure_heading && sub->d_tok.d_type != SynTree::R_function_heading )
+                continue;
+            foreach( const SynTree* id, sub->d_children )
+                if( id->d_tok.d_type == Tok_identifier )
+                    name += ( name.isEmpty() ? "" : "." ) + id->d_tok.d_val;
+        }
+        foreach( const SynTree* sub, st->d_children )
+            collectDecls(sub, out, sub->d_tok.d_type == SynTree::R_procedure_heading ||
+                         sub->d_tok.d_type == SynTree::R_function_heading ? outer : outer + name + "/");
+        return;
+    default:
+        break;
+    }
+    foreach( const SynTree* sub, st->d_children )
+        collectDecls(sub, out, outer);
+}
+
+static void runConfigs(const QString& root, const QStringList& configs)
+{
+    // each config is a comma separated list of name=value; a file is only preprocessed and parsed
+    // again if the variables it actually reads differ from all configs it was already parsed with
+    FileSystem fs;
+    fs.load(root);
+    const int off = fs.getRootPath().size();
+
+    QList<PpCode::PpVars> vars;
+    foreach( const QString& c, configs )
+    {
+        QHash<QByteArray,int> v;
+        foreach( const QString& def, c.split(',', QString::SkipEmptyParts) )
+        {
+            const int eq = def.indexOf('=');
+            if( eq < 0 )
+                v[def.trimmed().toUtf8()] = 1;
+            else
+                v[def.left(eq).trimmed().toUtf8()] = def.mid(eq+1).trimmed().toInt();
+        }
+        vars << PpCode::toSlots(v);
+    }
+
+    struct Result
+    {
+        QMap<int,qint32> d_inputs;
+        QSet<QByteArray> d_errors;
+        QSet<QByteArray> d_decls;
+    };
+    QVector<quint32> errCount(vars.size()), parsed(vars.size());
+    quint32 shared = 0, differing = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QList<const FileSystem::File*> files = fs.getAllPas();
+    foreach( const FileSystem::File* file, files )
+    {
+        QList<Result> results;
+        QVector<int> which(vars.size());
+        for( int k = 0; k < vars.size(); k++ )
+        {
+            which[k] = -1;
+            for( int r = 0; r < results.size() && which[k] < 0; r++ )
+            {
+                bool same = true;
+                QMap<int,qint32>::const_iterator i;
+                for( i = results[r].d_inputs.begin(); i != results[r].d_inputs.end() && same; ++i )
+                    same = i.value() == ( i.key() < vars[k].size() ? vars[k][i.key()] : 0 );
+                if( same )
+                    which[k] = r;
+            }
+            if( which[k] >= 0 )
+            {
+                shared++;
+                errCount[k] += results[which[k]].d_errors.size();
+                continue;
+            }
+            PpScanner lex(&fs);
+            lex.lex.setVars(vars[k]);
+            lex.lex.reset(file->d_realPath);
+            PascalParser p(&lex);
+            p.RunParser();
+            Result res;
+            res.d_inputs = lex.lex.getInputs();
+            foreach( const Parser::Error& e, p.errors )
+                res.d_errors << QString("%1:%2:%3: %4").arg(e.path.mid(off)).arg(e.row).arg(e.col).arg(e.msg).toUtf8();
+            collectDecls(&p.root, res.d_decls);
+            which[k] = results.size();
+            results << res;
+            parsed[k]++;
+            errCount[k] += res.d_errors.size();
+        }
+        if( results.size() <= 1 )
+            continue;
+
+        QSet<QByteArray> allErrs = results.first().d_errors, allDecls = results.first().d_decls;
+        for( int r = 1; r < results.size(); r++ )
+        {
+            allErrs.intersect(results[r].d_errors);
+            allDecls.intersect(results[r].d_decls);
+        }
+        bool header = false;
+        for( int k = 0; k < vars.size(); k++ )
+        {
+            const Result& res = results[which[k]];
+            QList<QByteArray> errs = (res.d_errors - allErrs).values();
+            QList<QByteArray> decls = (res.d_decls - allDecls).values();
+            if( errs.isEmpty() && decls.isEmpty() )
+                continue;
+            if( !header )
+            {
+                qDebug() << "**** configurations differ in" << file->getVirtualPath();
+                header = true;
+                differing++;
+            }
+            std::sort(errs.begin(),errs.end());
+            std::sort(decls.begin(),decls.end());
+            foreach( const QByteArray& e, errs )
+                qCritical() << "config" << k << "error" << e.constData();
+            foreach( const QByteArray& d, decls )
+                qDebug() << "config" << k << "declares" << d.constData();
+        }
+    }
+    for( int k = 0; k < vars.size(); k++ )
+        qDebug() << "#### config" << k << configs[k] << "has" << errCount[k] << "errors, parsed" << parsed[k]
+                 << "of" << files.size() << "files";
+    qDebug() << "#### finished" << vars.size() << "configurations in" << timer.elapsed() << "[ms]," << shared
+             << "parses shared," << differing << "files with differences";
+}
+
+static void exportTokens(const QString& root)
+{
+    // writes the preprocessed token stream of each unit to a .tok file next to it, see LisaTokenStream.h
+    FileSystem fs;
+    fs.load(root);
+    if( fs.isArchive() )
+    {
+        qCritical() << "cannot write .tok files into an archive, extract it first:" << root;
+        return;
+    }
+
+    QList<const FileSystem::File*> files = fs.getAllPas();
+    const int off = fs.getRootPath().size();
+    quint32 toks = 0;
+    QElapsedTimer timer;
+    timer.start();
+    foreach( const FileSystem::File* file, files )
+    {
+        PpLexer lex(&fs);
+        lex.reset(file->d_realPath);
+        TokStreamWriter w(fs.getRootPath());
+        Token t = lex.nextToken();
+        while( t.d_type != Tok_Eof )
+        {
+            if( t.d_type == Tok_Invalid )
+                qCritical() << t.d_sourcePath.mid(off) << t.d_lineNr << t.d_colNr << t.d_val;
+            w.add(t);
+            t = lex.nextToken();
+        }
+        if( !w.write(file->d_realPath + ".tok") )
+            qCritical() << "cannot open file for writing:" << file->d_realPath + ".tok";
+        toks += w.getTokenCount();
+    }
+    qDebug() << "#### exported" << toks << "tokens of" << files.size() << "files in" << timer.elapsed() << "[ms]";
+}
+
+static void exportTrees(const QString& root)
+{
+    // writes the syntax tree of each unit to a .syn file next to it, see LisaTreeStream.h
+    FileSystem fs;
+    fs.load(root);
+    if( fs.isArchive() )
+    {
+        qCritical() << "cannot write .syn files into an archive, extract it first:" << root;
+        return;
+    }
+
+    QList<const FileSystem::File*> files = fs.getAllPas();
+    const QList<QByteArray> names = treeNames();
+    quint32 nodes = 0;
+    QElapsedTimer timer;
+    timer.start();
+    foreach( const FileSystem::File* file, files )
+    {
+        PpScanner lex(&fs);
+        lex.lex.reset(file->d_realPath);
+        PascalParser p(&lex);
+        p.RunParser();
+        foreach( const Parser::Error& e, p.errors )
+            qCritical() << e.path.mid(fs.getRootPath().size()) << e.row << e.col << e.msg;
+        TreeStreamWriter w(fs.getRootPath(), SynTree::R_First, names);
+        w.add(&p.root);
+        if( !w.write(file->d_realPath + ".syn") )
+            qCritical() << "cannot open file for writing:" << file->d_realPath + ".syn";
+        nodes += w.getNodeCount();
+    }
+    qDebug() << "#### exported" << nodes << "nodes of" << files.size() << "files in" << timer.elapsed() << "[ms]";
+}
+
+class TokenScanner : public Scanner
+{
+public:
+    QList<Token> d_toks; // terminated by Tok_Eof
+    int d_pos;
+    TokenScanner():d_pos(0){}
+    Token next()
+    {
+        if( d_pos < d_toks.size() - 1 )
+            return d_toks[d_pos++];
+        return d_toks.last();
+    }
+    Token peek(int offset)
+    {
+        const int i = d_pos + offset - 1;
+        return i < d_toks.size() ? d_toks[i] : d_toks.last();
+    }
+};
+
+static bool sameTree(const SynTree* a, const SynTree* b)
+{
+    if( a->d_tok.d_type != b->d_tok.d_type || a->d_tok.d_val != b->d_tok.d_val ||
+            a->d_tok.d_lineNr != b->d_tok.d_lineNr || a->d_tok.d_colNr != b->d_tok.d_colNr ||
+            a->d_tok.d_sourcePath != b->d_tok.d_sourcePath || a->d_children.size() != b->d_children.size() )
+    {
+        qCritical() << "trees differ at" << a->d_tok.d_sourcePath << a->d_tok.d_lineNr << a->d_tok.d_colNr
+                    << a->d_tok.d_type << b->d_tok.d_type << a->d_children.size() << b->d_children.size();
+        return false;
+    }
+    for( int i = 0; i < a->d_children.size(); i++ )
+        if( !sameTree(a->d_children[i], b->d_children[i]) )
+            return false;
+    return true;
+}
+
+static bool sameToken(const Token& a, const Token& b)
+{
+    return a.d_type == b.d_type && a.d_lineNr == b.d_lineNr && a.d_colNr == b.d_colNr && a.d_val == b.d_val &&
+            a.d_sourcePath == b.d_sourcePath;
+}
+
+static void checkResume(const QString& root)
+{
+    // lexes each unit with checkpoints, then resumes at each checkpoint and checks that the remaining
+    // tokens, the line count and the checkpoints recorded again are the same as in the full run
+    FileSystem fs;
+    fs.load(root);
+
+    QList<const FileSystem::File*> files = fs.getAllPas();
+    const int off = fs.getRootPath().size();
+    int resumed = 0, failed = 0;
+    qint64 full = 0, partial = 0;
+    QElapsedTimer timer;
+    foreach( const FileSystem::File* file, files )
+    {
+        PpLexer lex(&fs);
+        lex.setCheckpointInterval(16);
+        timer.start();
+        lex.reset(file->d_realPath);
+        QList<Token> toks;
+        Token t;
+        do
+        {
+            t = lex.nextToken();
+            toks.append(t);
+        }while( t.d_type != Tok_Eof );
+        full += timer.nsecsElapsed();
+        const quint32 sloc = lex.getSloc();
+        const int count = lex.getCheckpointCount();
+        for( int i = 0; i < count; i++ )
+        {
+            const quint32 line = lex.getCheckpointLine(i);
+            timer.start();
+            bool ok = lex.resume(i);
+            int pos = lex.getCheckpointToken(i);
+            while( ok && pos < toks.size() )
+            {
+                t = lex.nextToken();
+                ok = sameToken(t, toks[pos]);
+                if( !ok || t.d_type == Tok_Eof )
+                    break;
+                pos++;
+            }
+            partial += timer.nsecsElapsed();
+            ok = ok && pos == toks.size() - 1 && lex.getSloc() == sloc && lex.getCheckpointCount() == count;
+            resumed++;
+            if( !ok )
+            {
+                if( pos < toks.size() && !sameToken(t, toks[pos]) )
+                    qCritical() << "resuming" << file->d_realPath.mid(off) << "at line" << line << "gives"
+                                << tokenTypeName(t.d_type) << t.d_lineNr << t.d_colNr << "instead of"
+                                << tokenTypeName(toks[pos].d_type) << toks[pos].d_lineNr << toks[pos].d_colNr;
+                else
+                    qCritical() << "resuming" << file->d_realPath.mid(off) << "at line" << line
+                                << "gives a different line count or checkpoints";
+                failed++;
+                break;
+            }
+        }
+    }
+    qDebug() << "#### resumed" << resumed << "times in" << files.size() << "files," << failed << "files differ";
+    qDebug() << "#### full runs" << full / 1000000 << "[ms], resumed runs on average"
+             << ( resumed ? partial / resumed / 1000 : 0 ) << "[us]";
+}
+
+static QStringList collectFilesQDir(const QString& dir, const QStringList& suffix)
+{
+    // the recursion FileSystem::load used before FileSystem::collectFiles, as reference
+    QStringList res;
+    QDir d(dir);
+    foreach( const QString& f, d.entryList( QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name ) )
+        res += collectFilesQDir( d.absoluteFilePath(f), suffix );
+    foreach( const QString& f, d.entryList( suffix, QDir::Files, QDir::Name ) )
+        res.append(d.absoluteFilePath(f));
+    return res;
+}
+
+static void benchFileSystem(const QString& root)
+{
+    // measures the directory walk against the QDir recursion, and include lookups and virtual paths
+    // of the loaded file system; the lookups are run twice, the second time all are memoized
+    const QStringList suffix = QStringList() << "*.txt" << "*.pas" << "*.inc";
+    const int runs = 5;
+    QStringList walked, reference;
+    QElapsedTimer timer;
+    timer.start();
+    for( int i = 0; i < runs; i++ )
+        walked = FileSystem::collectFiles(root, suffix);
+    const qint64 walk = timer.elapsed();
+    timer.restart();
+    for( int i = 0; i < runs; i++ )
+        reference = collectFilesQDir(root, suffix);
+    qDebug() << "#### walked" << walked.size() << "files in" << walk / runs << "[ms], QDir recursion"
+             << reference.size() << "files in" << timer.elapsed() / runs << "[ms]";
+    if( walked != reference )
+        qCritical() << "the walks found different files";
+
+    FileSystem fs;
+    timer.restart();
+    fs.load(root);
+    qDebug() << "#### loaded the file system in" << timer.elapsed() << "[ms]";
+
+    // 20 lookups per file of names spread over the tree, half with a directory, a quarter unknown
+    const QList<const FileSystem::File*> files = fs.getAllPas() + fs.getAllAsm();
+    const int n = files.size();
+    for( int pass = 0; pass < 2 && n; pass++ )
+    {
+        int found = 0;
+        timer.restart();
+        for( int i = 0; i < n; i++ )
+        {
+            for( int j = 0; j < 20; j++ )
+            {
+                const FileSystem::File* f = files[( i * 7 + j * 13 ) % n];
+                const QString name = j % 4 == 3 ? f->d_name + "_" : f->d_name;
+                const QString dir = j % 2 ? f->d_dir->d_name : QString();
+                if( fs.findFile(files[i]->d_dir, dir, name) )
+                    found++;
+            }
+        }
+        qDebug() << "####" << n * 20 << "include lookups in" << timer.elapsed() << "[ms]," << found << "found,"
+                 << fs.getLookupHits() << "memoized so far";
+    }
+    int len = 0;
+    timer.restart();
+    for( int i = 0; i < 20; i++ )
+        foreach( const FileSystem::File* f, files )
+            len += f->getVirtualPath().size();
+    qDebug() << "####" << n * 20 << "virtual paths in" << timer.elapsed() << "[ms]";
+}
+
+static void findFiles(const QString& root, const QStringList& queries)
+{
+    // runs the quick open queries of the navigator against the file index
+    FileSystem fs;
+    fs.load(root);
+    QElapsedTimer timer;
+    timer.start();
+    FileIndex index;
+    index.build(&fs);
+    qDebug() << "#### indexed" << index.getCount() << "files in" << timer.elapsed() << "[ms]";
+    foreach( const QString& q, queries )
+    {
+        const int runs = 1000;
+        QList<FileIndex::Hit> hits;
+        timer.restart();
+        for( int i = 0; i < runs; i++ )
+            hits = index.find(q, 10);
+        qDebug() << "####" << q << "in" << timer.nsecsElapsed() / runs / 1000.0 << "[us]";
+        foreach( const FileIndex::Hit& h, hits )
+            qDebug() << h.d_score << h.d_file->getVirtualPath();
+    }
+}
+
+static void compareParsers(const QString& root)
+{
+    // parses each unit with the recursive descent and the table driven parser from the same token
+    // list, so only the parsers are measured, and checks that both produce the same trees and errors
+    FileSystem fs;
+    fs.load(root);
+
+    QList<const FileSystem::File*> files = fs.getAllPas();
+    qint64 rd = 0, table = 0;
+    int same = 0;
+    QElapsedTimer timer;
+    foreach( const FileSystem::File* file, files )
+    {
+        TokenScanner toks;
+        PpLexer lex(&fs);
+        lex.reset(file->d_realPath);
+        Token t = lex.nextToken();
+        while( t.d_type != Tok_Eof )
+        {
+            toks.d_toks.append(t);
+            t = lex.nextToken();
+        }
+        toks.d_toks.append(t);
+
+        timer.start();
+        Parser p1(&toks);
+        p1.RunParser();
+        rd += timer.nsecsElapsed();
+
+        toks.d_pos = 0;
+        timer.start();
+        TableParser p2(&toks);
+        p2.RunParser();
+        table += timer.nsecsElapsed();
+
+        bool ok = sameTree(&p1.root, &p2.root) && p1.errors.size() == p2.errors.size();
+        for( int i = 0; ok && i < p1.errors.size(); i++ )
+            ok = p1.errors[i].msg == p2.errors[i].msg && p1.errors[i].row == p2.errors[i].row &&
+                    p1.errors[i].col == p2.errors[i].col && p1.errors[i].path == p2.errors[i].path;
+        if( ok )
+            same++;
+        else
+            qCritical() << "**** parsers differ on" << file->getVirtualPath();
+    }
+    qDebug() << "#### same result for" << same << "of" << files.size() << "files";
+    qDebug() << "#### recursive descent" << rd / 1000000 << "[ms], table driven" << table / 1000000 << "[ms]";
 }
 
 static void checkTokens(const QStringList& files)
@@ -289,7 +769,246 @@ static void convert(const QString& root)
         QDir from = info.dir();
         QDir to( from.path() + "/converted" );
         Converter::convert(from,to);
+    }else if( Archive::isArchive(root) )
+        Converter::convertArchive(root, QDir(info.absolutePath() + "/converted"));
+}
+
+static quint32 countDecls(const Scope* scope)
+{
+    if( scope == 0 )
+        return 0;
+    quint32 res = 0;
+    foreach( Declaration* d, scope->d_order )
+    {
+        res++;
+        res += countDecls(d->d_body);
+        if( d->d_kind == Thing::TypeDecl && d->d_type && d->d_type->d_members &&
+                ( d->d_type->d_members->d_outer == scope || d->d_type->d_members->d_altOuter == scope ) )
+            res += countDecls(d->d_type->d_members);
+    }
+    return res;
+}
+
+static void loadModel(const QString& root)
+{
+    // builds the code model like the navigator does, then measures a traversal of all declarations
+    // and freeing the model, which depend on how the declarations are laid out in memory
+    QElapsedTimer timer;
+    timer.start();
+    CodeModel* mdl = new CodeModel();
+    mdl->load(root);
+    qDebug() << "#### loaded" << mdl->getSloc() << "SLOC with" << mdl->getErrCount() << "errors in"
+             << timer.elapsed() << "[ms]";
+    timer.restart();
+    quint32 count = 0;
+    const FileSystem* fs = mdl->getFs();
+    foreach( const FileSystem::File* f, fs->getAllPas() + fs->getAllAsm() )
+    {
+        CodeFile* cf = mdl->getCodeFile(f->d_realPath);
+        if( cf == 0 )
+            continue;
+        if( UnitFile* uf = cf->toUnit() )
+            count += countDecls(uf->d_intf) + countDecls(uf->d_impl);
+        else if( AsmFile* af = cf->toAsmFile() )
+            count += countDecls(af->d_impl);
+    }
+    qDebug() << "#### traversed" << count << "declarations in" << timer.elapsed() << "[ms]";
+    timer.restart();
+    delete mdl;
+    qDebug() << "#### freed the model in" << timer.elapsed() << "[ms]";
+}
+
+static QString toString(const FilePos& loc)
+{
+    return QFileInfo(loc.d_filePath).fileName() + ":" + QString::number(loc.d_pos.d_row) + ":" +
+            QString::number(loc.d_pos.d_col);
+}
+
+static void dumpDecls(const Scope* scope, const QString& indent, QStringList& out)
+{
+    if( scope == 0 )
+        return;
+    foreach( Declaration* d, scope->d_order )
+    {
+        QStringList refs;
+        for( Declaration::Refs::const_iterator i = d->d_refs.begin(); i != d->d_refs.end(); ++i )
+            foreach( Symbol* sy, i.value() )
+                refs << toString(FilePos(sy->d_loc, i.key()));
+        refs.sort();
+        out << indent + d->getName() + " " + QString::number(d->d_kind) + " " + toString(d->d_loc) +
+               " refs " + refs.join(" ");
+        dumpDecls(d->d_body, indent + "  ", out);
+        if( d->d_kind == Thing::TypeDecl && d->d_type && d->d_type->d_members &&
+                ( d->d_type->d_members->d_outer == scope || d->d_type->d_members->d_altOuter == scope ) )
+            dumpDecls(d->d_type->d_members, indent + "  ", out);
+    }
+}
+
+static QStringList dumpModel(CodeModel* mdl)
+{
+    // what reparseRoutine maintains, independent of the order in which it was added
+    QStringList out;
+    foreach( const FileSystem::File* f, mdl->getFs()->getAllPas() )
+    {
+        UnitFile* uf = mdl->getUnitFile(f->d_realPath);
+        if( uf == 0 || uf->d_file != f )
+            continue;
+        out << f->getVirtualPath();
+        dumpDecls(uf->d_intf, "  ", out);
+        dumpDecls(uf->d_impl, "  ", out);
+        QStringList syms;
+        for( QHash<QString,UnitFile::SymList>::const_iterator i = uf->d_syms.begin(); i != uf->d_syms.end(); ++i )
+            foreach( Symbol* sy, i.value() )
+                syms << "  symbol " + toString(FilePos(sy->d_loc, i.key())) + " " +
+                        ( sy->d_decl ? sy->d_decl->getName() : QString("?") );
+        syms.sort();
+        out += syms;
+        foreach( const Range& r, mdl->getMutes(f->d_realPath) )
+            out << "  muted " + QString::number(r.first.d_row) + " " + QString::number(r.second.d_row);
+    }
+    const CallGraph* cg = mdl->getCalls();
+    QStringList calls;
+    for( int i = 0; i < cg->getCallCount(); i++ )
+    {
+        const CallGraph::Call& c = cg->getCall(i);
+        QString line = "call " + c.d_caller->getName() + " " + c.d_callee->getName() + " " + toString(c.d_loc);
+        bool callee = false, caller = false;
+        CallGraph::Range r = cg->getCallers(c.d_callee);
+        for( const quint32* j = r.first; j != r.second; ++j )
+            callee = callee || *j == quint32(i);
+        r = cg->getCallees(c.d_caller);
+        for( const quint32* j = r.first; j != r.second; ++j )
+            caller = caller || *j == quint32(i);
+        if( !callee || !caller )
+            line += " not indexed";
+        calls << line;
+    }
+    calls.sort();
+    out += calls;
+    out << "sloc " + QString::number(mdl->getSloc());
+    return out;
+}
+
+static bool routineLessThan(const Declaration* lhs, const Declaration* rhs)
+{
+    return lhs->d_loc.d_filePath < rhs->d_loc.d_filePath ||
+            ( lhs->d_loc.d_filePath == rhs->d_loc.d_filePath && lhs->d_loc.d_pos < rhs->d_loc.d_pos );
+}
+
+static void checkReparse(const QString& root, int count)
+{
+    // edits routines in a copy of the tree one after the other by inserting a call of the routine and
+    // an empty line before its END, or every fourth time an unmatched BEGIN. After each edit the routine
+    // is reparsed and the model compared with a full load of the edited tree; if reparseRoutine refuses,
+    // the model must be unchanged and the edit is undone.
+    if( !QFileInfo(root).isDir() )
+    {
+        qCritical() << "-reparse needs a directory:" << root;
+        return;
+    }
+    const QString from = QDir(root).absolutePath();
+    const QString work = QDir::tempPath() + "/LisaReparse";
+    QDir(work).removeRecursively();
+    foreach( const QString& f, FileSystem::collectFiles(from, QStringList() << "*.txt" << "*.pas" << "*.inc") )
+    {
+        const QString to = work + f.mid(from.size());
+        QDir().mkpath(QFileInfo(to).absolutePath());
+        QFile::copy(f, to);
+    }
+
+    CodeModel mdl;
+    mdl.setIncremental(true);
+    mdl.load(work);
+    QList<Declaration*> routines;
+    foreach( const FileSystem::File* f, mdl.getFs()->getAllPas() )
+    {
+        UnitFile* uf = mdl.getUnitFile(f->d_realPath);
+        if( uf && uf->d_file == f && uf->d_stream )
+            foreach( const Declaration* d, uf->d_stream->d_routines.keys() )
+                routines << const_cast<Declaration*>(d);
+    }
+    std::sort(routines.begin(), routines.end(), routineLessThan);
+    const int step = qMax(1, routines.size() / qMax(count, 1));
+
+    int reparsed = 0, refused = 0, skipped = 0, failed = 0;
+    qint64 incremental = 0, full = 0;
+    QElapsedTimer timer;
+    for( int n = 0; n < routines.size() && reparsed + refused < count; n += step )
+    {
+        Declaration* d = routines[n];
+        UnitFile* uf = mdl.getUnitFile(d->d_loc.d_filePath);
+        if( uf == 0 || uf->d_stream == 0 || !uf->d_stream->d_routines.contains(d) )
+        {
+            skipped++; // e.g. nested in a routine reparsed before
+            continue;
+        }
+        const RowCol end = uf->d_stream->d_routines.value(d).second;
+        const QString path = uf->d_file->d_realPath;
+        QFile in(path);
+        in.open(QIODevice::ReadOnly);
+        const QByteArray text = in.readAll();
+        in.close();
+        int pos = 0;
+        for( quint32 row = 1; row < end.d_row && pos >= 0; row++ )
+        {
+            pos = text.indexOf('\n', pos);
+            if( pos >= 0 )
+                pos++;
+        }
+        pos += end.d_col - 1;
+        if( pos < 0 || qstrnicmp(text.constData() + pos, "end", 3) != 0 )
+        {
+            skipped++; // e.g. a forward or external declaration
+            continue;
+        }
+        QByteArray edited = text;
+        if( ( reparsed + refused ) % 4 == 3 )
+            edited.insert(pos, "begin\n" + QByteArray(end.d_col - 1, ' ')); // must be refused
+        else
+            edited.insert(pos, d->d_name + ";\n\n" + QByteArray(end.d_col - 1, ' '));
+        QFile out(path);
+        out.open(QIODevice::WriteOnly);
+        out.write(edited);
+        out.close();
+
+        const QStringList before = dumpModel(&mdl);
+        timer.start();
+        const bool ok = mdl.reparseRoutine(d);
+        incremental += timer.nsecsElapsed();
+        QStringList after = dumpModel(&mdl);
+        QStringList expected;
+        if( ok )
+        {
+            reparsed++;
+            timer.start();
+            CodeModel ref;
+            ref.setIncremental(true); // lexes to the end also after parse errors
+            ref.load(work);
+            full += timer.nsecsElapsed();
+            expected = dumpModel(&ref);
+        }else
+        {
+            refused++;
+            expected = before;
+            out.open(QIODevice::WriteOnly);
+            out.write(text);
+            out.close();
+        }
+        if( after != expected )
+        {
+            failed++;
+            int i = 0;
+            while( i < after.size() && i < expected.size() && after[i] == expected[i] )
+                i++;
+            qCritical() << ( ok ? "reparsing" : "refusing to reparse" ) << d->getName() << "in"
+                        << path.mid(work.size()) << "gives" << after.value(i) << "instead of" << expected.value(i);
+        }
     }
+    qDebug() << "#### reparsed" << reparsed << "routines, refused" << refused << "skipped" << skipped << ","
+             << failed << "differ from a full load";
+    if( reparsed )
+        qDebug() << "#### reparse on average" << incremental / ( reparsed + refused ) / 1000 << "[us], full load"
+                 << full / reparsed / 1000 << "[us]";
 }
 
 static void checkFileNames(const QStringList& files)
@@ -337,8 +1056,58 @@ int main(int argc, char *argv[])
     //checkFileNames(files);
     //checkTokens(files);
 #else
+    if( a.arguments()[1] == "-pp" && a.arguments().size() > 2 )
+    {
+        runPreprocessor(a.arguments()[2]);
+        return 0;
+    }
+    if( a.arguments()[1] == "-cfg" && a.arguments().size() > 3 )
+    {
+        runConfigs(a.arguments()[2], a.arguments().mid(3));
+        return 0;
+    }
+    if( a.arguments()[1] == "-tok" && a.arguments().size() > 2 )
+    {
+        exportTokens(a.arguments()[2]);
+        return 0;
+    }
+    if( a.arguments()[1] == "-syn" && a.arguments().size() > 2 )
+    {
+        exportTrees(a.arguments()[2]);
+        return 0;
+    }
+    if( a.arguments()[1] == "-resume" && a.arguments().size() > 2 )
+    {
+        checkResume(a.arguments()[2]);
+        return 0;
+    }
+    if( a.arguments()[1] == "-fs" && a.arguments().size() > 2 )
+    {
+        benchFileSystem(a.arguments()[2]);
+        return 0;
+    }
+    if( a.arguments()[1] == "-find" && a.arguments().size() > 3 )
+    {
+        findFiles(a.arguments()[2], a.arguments().mid(3));
+        return 0;
+    }
+    if( a.arguments()[1] == "-cmp" && a.arguments().size() > 2 )
+    {
+        compareParsers(a.arguments()[2]);
+        return 0;
+    }
+    if( a.arguments()[1] == "-model" && a.arguments().size() > 2 )
+    {
+        loadModel(a.arguments()[2]);
+        return 0;
+    }
+    if( a.arguments()[1] == "-reparse" && a.arguments().size() > 2 )
+    {
+        checkReparse(a.arguments()[2], a.arguments().size() > 3 ? a.arguments()[3].toInt() : 20);
+        return 0;
+    }
     QFileInfo info(a.arguments()[1]);
-    if( info.isDir() )
+    if( info.isDir() || Archive::isArchive(info.filePath()) )
         runParser(a.arguments()[1]);
     else
         runParser(info.absolutePath(),info.absoluteFilePath());
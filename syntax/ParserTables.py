@@ -0,0 +1,272 @@
+#!/usr/bin/env python3
+# Copyright 2023 Rochus Keller <mailto:me@rochus-keller.ch> and others
+#
+# Generates ../LisaParserTables.h for the table driven parser (LisaTableParser.cpp).
+#
+# The input is the recursive descent parser which EbnfStudio generates from LisaPascal.ebnf, so both
+# parsers take exactly the same decisions (FIRST sets, follow tokens of nullable alternatives and the
+# \LA and \LL predicates) and produce the same trees and errors. Run it each time LisaParser.cpp was
+# regenerated:
+#
+#   cd syntax; python3 ParserTables.py
+
+import re
+import sys
+
+src = open(sys.argv[1] if len(sys.argv) > 1 else '../LisaParser.cpp').read()
+out_path = sys.argv[2] if len(sys.argv) > 2 else '../LisaParserTables.h'
+
+# FIRST sets
+firsts = {}
+for m in re.finditer(r'static inline bool FIRST_(\w+)\(int tt\) \{(.*?)\n\}', src, re.S):
+    firsts[m.group(1)] = frozenset(re.findall(r'Tok_\w+', m.group(2)))
+
+# conditions: FIRST_x(la.d_type), la.d_type == Tok_x, peek(n).d_type == Tok_x, !, &&, ||, ( )
+def cond_tokens(s):
+    res = []
+    i = 0
+    pat = re.compile(r'\s*(FIRST_(\w+)\(la\.d_type\)|la\.d_type == (Tok_\w+)|peek\((\d)\)\.d_type == (Tok_\w+)|\|\||&&|!|\(|\))')
+    while i < len(s):
+        m = pat.match(s, i)
+        if not m:
+            if s[i:].strip() == '':
+                break
+            raise Exception('cannot parse condition: ' + s[i:])
+        i = m.end()
+        if m.group(2):
+            res.append(('in', 1, firsts[m.group(2)]))
+        elif m.group(3):
+            res.append(('in', 1, frozenset([m.group(3)])))
+        elif m.group(4):
+            res.append(('in', int(m.group(4)), frozenset([m.group(5)])))
+        else:
+            res.append(m.group(1).strip())
+    return res
+
+def parse_cond(toks):
+    pos = [0]
+    def peek():
+        return toks[pos[0]] if pos[0] < len(toks) else None
+    def take():
+        pos[0] += 1
+        return toks[pos[0] - 1]
+    def orx():
+        terms = [andx()]
+        while peek() == '||':
+            take()
+            terms.append(andx())
+        return terms[0] if len(terms) == 1 else ('or', terms)
+    def andx():
+        terms = [unary()]
+        while peek() == '&&':
+            take()
+            terms.append(unary())
+        return terms[0] if len(terms) == 1 else ('and', terms)
+    def unary():
+        t = take()
+        if t == '!':
+            return ('not', unary())
+        if t == '(':
+            e = orx()
+            assert take() == ')'
+            return e
+        return t
+    e = orx()
+    assert pos[0] == len(toks)
+    return e
+
+def simplify(e):
+    # an alternative of membership tests of the same token is a single test
+    if e[0] == 'or':
+        terms = [simplify(t) for t in e[1]]
+        merged = {}
+        rest = []
+        for t in terms:
+            if t[0] == 'in':
+                merged[t[1]] = merged.get(t[1], frozenset()) | t[2]
+            else:
+                rest.append(t)
+        terms = [('in', k, s) for k, s in sorted(merged.items())] + rest
+        return terms[0] if len(terms) == 1 else ('or', terms)
+    if e[0] == 'and':
+        return ('and', [simplify(t) for t in e[1]])
+    if e[0] == 'not':
+        return ('not', simplify(e[1]))
+    return e
+
+sets = []
+set_index = {}
+def set_of(s):
+    if s not in set_index:
+        set_index[s] = len(sets)
+        sets.append(s)
+    return set_index[s]
+
+conds = []
+cond_index = {}
+def cond_of(text):
+    e = simplify(parse_cond(cond_tokens(text)))
+    code = []
+    def gen(e):
+        if e[0] == 'in':
+            code.extend(['CondIn', str(e[1]), str(set_of(e[2]))])
+        elif e[0] == 'not':
+            gen(e[1])
+            code.append('CondNot')
+        else:
+            gen(e[1][0])
+            for t in e[1][1:]:
+                gen(t)
+                code.append('CondAnd' if e[0] == 'and' else 'CondOr')
+    gen(e)
+    code.append('CondEnd')
+    key = tuple(code)
+    if key not in cond_index:
+        cond_index[key] = len(conds)
+        conds.append(code)
+    return cond_index[key]
+
+names = []
+name_index = {}
+def name_of(n):
+    if n not in name_index:
+        name_index[n] = len(names)
+        names.append(n)
+    return name_index[n]
+
+# rule bodies
+rules = []
+for m in re.finditer(r'\nvoid Parser::(\w+)\(SynTree\* st\) \{\n(.*?)\n\}', src, re.S):
+    rules.append((m.group(1), [l.strip() for l in m.group(2).split('\n') if l.strip()]))
+
+code = [] # list of words; labels are resolved afterwards
+rule_start = {}
+calls = {} # rule name -> Label of its start address
+
+class Label:
+    def __init__(self):
+        self.addr = None
+
+def emit(*words):
+    code.extend(words)
+
+def block(lines, i):
+    # translates statements up to the closing brace; returns the index behind it
+    while i < len(lines):
+        l = lines[i]
+        m = re.match(r'\{ SynTree\* tmp = new SynTree\(SynTree::(R_\w+), la\); st->d_children.append\(tmp\); st = tmp; \}$', l)
+        if m:
+            emit('OpNode', 'SynTree::' + m.group(1))
+            i += 1
+            continue
+        m = re.match(r'if\( expect\((Tok_\w+), (true|false), "(\w+)"\) \) addTerminal\(st\);$', l)
+        if m:
+            emit('OpExpect', m.group(1), '1' if m.group(2) == 'true' else '0', str(name_of(m.group(3))))
+            i += 1
+            continue
+        m = re.match(r'invalid\("(\w+)"\);$', l)
+        if m:
+            emit('OpInvalid', str(name_of(m.group(1))))
+            i += 1
+            continue
+        m = re.match(r'(\w+)\(st\);$', l)
+        if m:
+            emit('OpCall', calls.setdefault(m.group(1), Label()))
+            i += 1
+            continue
+        m = re.match(r'while\( (.*) \) \{$', l)
+        if m:
+            top = len(code)
+            end = Label()
+            emit('OpJumpIfNot', str(cond_of(m.group(1))), end)
+            i = block(lines, i + 1)
+            emit('OpJump', top)
+            end.addr = len(code)
+            continue
+        m = re.match(r'if\( (.*) \) \{$', l)
+        if m:
+            end = Label()
+            cond = m.group(1)
+            i += 1
+            while True:
+                nxt = Label()
+                emit('OpJumpIfNot', str(cond_of(cond)), nxt)
+                i = block(lines, i)
+                l = lines[i - 1]
+                emit('OpJump', end)
+                nxt.addr = len(code)
+                m = re.match(r'\} else if\( (.*) \) \{$', l)
+                if m:
+                    cond = m.group(1)
+                    continue
+                if l == '} else':
+                    m = re.match(r'invalid\("(\w+)"\);$', lines[i])
+                    assert m
+                    emit('OpInvalid', str(name_of(m.group(1))))
+                    i += 1
+                break
+            end.addr = len(code)
+            continue
+        if l == '}' or l.startswith('} else'):
+            return i + 1
+        raise Exception('cannot translate: ' + l)
+    return i
+
+rule_ids = [] # (SynTree::R_x, rule name) of the rules which create a node
+for name, lines in rules:
+    m = re.match(r'\{ SynTree\* tmp = new SynTree\(SynTree::(R_\w+), la\);', lines[0])
+    if m:
+        rule_ids.append(('SynTree::' + m.group(1), name))
+    rule_start[name] = len(code)
+    assert block(lines, 0) == len(lines)
+    emit('OpRet')
+for name, l in calls.items():
+    l.addr = rule_start[name]
+assert rule_start[rules[0][0]] == 0 # the start rule
+
+def word(w):
+    if isinstance(w, Label):
+        return str(w.addr)
+    if isinstance(w, int):
+        return str(w)
+    return w
+
+with open(out_path, 'w') as f:
+    f.write('// This file was automatically generated by syntax/ParserTables.py from LisaParser.cpp; don\'t modify it!\n\n')
+    f.write('static const char* const s_names[] = {\n')
+    for n in names:
+        f.write('\t"%s",\n' % n)
+    f.write('};\n')
+    f.write('// token sets, each terminated by SetEnd\n')
+    f.write('static const quint16 s_sets[] = {\n')
+    for s in sets:
+        f.write('\t' + ', '.join(sorted(s)) + ', SetEnd,\n')
+    f.write('};\n')
+    f.write('enum { SetCount = %d };\n\n' % len(sets))
+    f.write('static const quint16 s_conds[] = {\n')
+    starts = []
+    n = 0
+    for c in conds:
+        starts.append(n)
+        n += len(c)
+        f.write('\t' + ', '.join(c) + ',\n')
+    f.write('};\n')
+    f.write('static const quint16 s_condStart[] = { %s };\n\n' % ', '.join(str(s) for s in starts))
+    f.write('// start address of each rule, by the type of the node it creates\n')
+    f.write('static const quint16 s_rules[] = {\n')
+    for r, name in rule_ids:
+        f.write('\t%s, %d,\n' % (r, rule_start[name]))
+    f.write('};\n')
+    f.write('enum { RuleCount = %d };\n\n' % len(rule_ids))
+    f.write('static const quint16 s_code[] = {\n')
+    addr = {v: k for k, v in rule_start.items()}
+    i = 0
+    ops = {'OpNode': 1, 'OpExpect': 3, 'OpCall': 1, 'OpJumpIfNot': 2, 'OpJump': 1, 'OpInvalid': 1, 'OpRet': 0}
+    while i < len(code):
+        if i in addr:
+            f.write('\t// %d: %s\n' % (i, addr[i]))
+        op = code[i]
+        argc = ops[op]
+        f.write('\t' + ', '.join(word(w) for w in code[i:i + argc + 1]) + ',\n')
+        i += argc + 1
+    f.write('};\n')